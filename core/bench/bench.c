@@ -0,0 +1,329 @@
+/**
+ * AI-OS Microbenchmark Harness
+ * Drives the native hot paths in-process and over loopback sockets:
+ * HAL sysfs and mixer reads, cJSON build/parse for chat payloads, frame
+ * throughput, IPC round-trips at varying concurrency and VAD blocks.
+ *
+ * Output is one machine-parsable line per benchmark, trackable per
+ * release:
+ *
+ *   BENCH <name> iters=<n> ops_sec=<f> p50_us=<f> p99_us=<f> [mb_sec=<f>]
+ *
+ * Build & run: make bench
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <math.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <cjson/cJSON.h>
+
+#include "hal.h"
+#include "ipc.h"
+#include "vad.h"
+
+#define BENCH_SOCKET "/tmp/aios-bench.sock"
+
+/* ==================== Latency Collection ==================== */
+
+typedef struct {
+    uint64_t *lat;      /* one sample per operation, microseconds */
+    int count;
+    int cap;
+} lat_buf_t;
+
+static void lat_add(lat_buf_t *l, uint64_t us) {
+    if (l->count == l->cap) {
+        l->cap = l->cap ? l->cap * 2 : 4096;
+        l->lat = realloc(l->lat, l->cap * sizeof(uint64_t));
+        if (!l->lat) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    l->lat[l->count++] = us;
+}
+
+static int lat_cmp(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Sort, summarize and print one result line; bytes_per_op 0 omits mb_sec */
+static void report(const char *name, lat_buf_t *l, double wall_secs,
+                   double bytes_per_op) {
+    if (l->count == 0 || wall_secs <= 0) {
+        printf("BENCH %s iters=0 ops_sec=0 p50_us=0 p99_us=0\n", name);
+        return;
+    }
+
+    qsort(l->lat, l->count, sizeof(uint64_t), lat_cmp);
+    uint64_t p50 = l->lat[l->count / 2];
+    uint64_t p99 = l->lat[(l->count * 99) / 100 < l->count
+                          ? (l->count * 99) / 100 : l->count - 1];
+    double ops_sec = l->count / wall_secs;
+
+    printf("BENCH %s iters=%d ops_sec=%.0f p50_us=%.1f p99_us=%.1f",
+           name, l->count, ops_sec, (double)p50, (double)p99);
+    if (bytes_per_op > 0) {
+        printf(" mb_sec=%.1f", ops_sec * bytes_per_op / (1024.0 * 1024.0));
+    }
+    printf("\n");
+
+    free(l->lat);
+    memset(l, 0, sizeof(*l));
+}
+
+/* ==================== HAL ==================== */
+
+static void bench_hal(void) {
+    lat_buf_t l = {0};
+    uint64_t t0, start;
+
+    start = aios_stats_now_us();
+    for (int i = 0; i < 5000; i++) {
+        t0 = aios_stats_now_us();
+        hal_brightness_get();
+        lat_add(&l, aios_stats_now_us() - t0);
+    }
+    report("hal_brightness_get", &l, (aios_stats_now_us() - start) / 1e6, 0);
+
+    battery_info_t bat;
+    start = aios_stats_now_us();
+    for (int i = 0; i < 2000; i++) {
+        t0 = aios_stats_now_us();
+        hal_battery_get(&bat);
+        lat_add(&l, aios_stats_now_us() - t0);
+    }
+    report("hal_battery_get", &l, (aios_stats_now_us() - start) / 1e6, 0);
+
+    start = aios_stats_now_us();
+    for (int i = 0; i < 2000; i++) {
+        t0 = aios_stats_now_us();
+        hal_volume_get();
+        lat_add(&l, aios_stats_now_us() - t0);
+    }
+    report("hal_volume_get", &l, (aios_stats_now_us() - start) / 1e6, 0);
+}
+
+/* ==================== cJSON ==================== */
+
+/* Mirrors the shape the agent builds and parses per chat turn */
+static const char CHAT_RESPONSE[] =
+    "{\"id\":\"chatcmpl-bench\",\"object\":\"chat.completion\","
+    "\"choices\":[{\"index\":0,\"message\":{\"role\":\"assistant\","
+    "\"content\":\"The current brightness is 70%. I can adjust it for "
+    "you - just say a level between 0 and 100.\"},"
+    "\"finish_reason\":\"stop\"}],"
+    "\"usage\":{\"prompt_tokens\":184,\"completion_tokens\":28}}";
+
+static void bench_cjson(void) {
+    lat_buf_t l = {0};
+    uint64_t t0, start;
+
+    start = aios_stats_now_us();
+    for (int i = 0; i < 50000; i++) {
+        t0 = aios_stats_now_us();
+        cJSON *msg = cJSON_CreateObject();
+        cJSON_AddStringToObject(msg, "cmd", "chat");
+        cJSON_AddStringToObject(msg, "text", "set the brightness to 70 percent");
+        cJSON_AddBoolToObject(msg, "stream", 1);
+        char *s = cJSON_PrintUnformatted(msg);
+        cJSON_Delete(msg);
+        cJSON_free(s);
+        lat_add(&l, aios_stats_now_us() - t0);
+    }
+    report("cjson_build_chat", &l, (aios_stats_now_us() - start) / 1e6, 0);
+
+    start = aios_stats_now_us();
+    for (int i = 0; i < 50000; i++) {
+        t0 = aios_stats_now_us();
+        cJSON *json = cJSON_Parse(CHAT_RESPONSE);
+        cJSON_Delete(json);
+        lat_add(&l, aios_stats_now_us() - t0);
+    }
+    report("cjson_parse_chat", &l, (aios_stats_now_us() - start) / 1e6,
+           sizeof(CHAT_RESPONSE) - 1);
+}
+
+/* ==================== Framing Throughput ==================== */
+
+static void *echo_thread(void *arg) {
+    int fd = *(int *)arg;
+    char *buf = malloc(AIOS_IPC_MAX_MSG);
+
+    while (buf && aios_ipc_recv_frame(fd, buf, AIOS_IPC_MAX_MSG) == 0) {
+        if (aios_ipc_send_frame(fd, buf, strlen(buf)) < 0) break;
+    }
+    free(buf);
+    return NULL;
+}
+
+static void bench_framing(void) {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+        perror("socketpair");
+        return;
+    }
+
+    pthread_t echo;
+    pthread_create(&echo, NULL, echo_thread, &sv[1]);
+
+    char payload[4096];
+    memset(payload, 'x', sizeof(payload) - 1);
+    payload[sizeof(payload) - 1] = '\0';
+    char resp[AIOS_IPC_MAX_MSG];
+
+    lat_buf_t l = {0};
+    uint64_t start = aios_stats_now_us();
+    for (int i = 0; i < 20000; i++) {
+        uint64_t t0 = aios_stats_now_us();
+        if (aios_ipc_send_frame(sv[0], payload, sizeof(payload) - 1) < 0 ||
+            aios_ipc_recv_frame(sv[0], resp, sizeof(resp)) < 0) {
+            break;
+        }
+        lat_add(&l, aios_stats_now_us() - t0);
+    }
+    /* One op moves the payload both ways */
+    report("framing_4k", &l, (aios_stats_now_us() - start) / 1e6,
+           2.0 * (sizeof(payload) - 1));
+
+    close(sv[0]);
+    pthread_join(echo, NULL);
+    close(sv[1]);
+}
+
+/* ==================== IPC Round-Trips ==================== */
+
+static volatile int g_server_running = 1;
+static aios_ipc_server_t g_server;
+
+static void cmd_ping(int client_fd, const char *msg,
+                     char *response, size_t response_size) {
+    (void)client_fd; (void)msg; (void)response; (void)response_size;
+}
+
+static const aios_ipc_cmd_t g_bench_cmds[] = {
+    { "ping", cmd_ping },
+    { NULL, NULL }
+};
+
+static void *server_thread(void *arg) {
+    (void)arg;
+    aios_ipc_server_run(&g_server, &g_server_running);
+    return NULL;
+}
+
+struct rtt_arg {
+    int iters;
+    lat_buf_t lat;
+};
+
+static void *rtt_thread(void *arg) {
+    struct rtt_arg *a = arg;
+    aios_ipc_t conn;
+    aios_ipc_init(&conn, BENCH_SOCKET);
+
+    char resp[256];
+    for (int i = 0; i < a->iters; i++) {
+        uint64_t t0 = aios_stats_now_us();
+        if (aios_ipc_request(&conn, "{\"cmd\":\"ping\"}", resp, sizeof(resp)) < 0) {
+            break;
+        }
+        lat_add(&a->lat, aios_stats_now_us() - t0);
+    }
+    aios_ipc_close(&conn);
+    return NULL;
+}
+
+static void bench_ipc_rtt(int nthreads, int iters_per_thread) {
+    pthread_t threads[16];
+    struct rtt_arg args[16];
+    if (nthreads > 16) nthreads = 16;
+
+    uint64_t start = aios_stats_now_us();
+    for (int i = 0; i < nthreads; i++) {
+        args[i].iters = iters_per_thread;
+        memset(&args[i].lat, 0, sizeof(args[i].lat));
+        pthread_create(&threads[i], NULL, rtt_thread, &args[i]);
+    }
+
+    lat_buf_t merged = {0};
+    for (int i = 0; i < nthreads; i++) {
+        pthread_join(threads[i], NULL);
+        for (int j = 0; j < args[i].lat.count; j++) {
+            lat_add(&merged, args[i].lat.lat[j]);
+        }
+        free(args[i].lat.lat);
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "ipc_rtt_c%d", nthreads);
+    report(name, &merged, (aios_stats_now_us() - start) / 1e6, 0);
+}
+
+/* ==================== VAD ==================== */
+
+static void bench_vad(void) {
+    /* Canned 20ms block at 16kHz: tone plus deterministic noise, loud
+     * enough to exercise the full speech path after warmup */
+    int16_t block[320];
+    unsigned seed = 12345;
+    for (int i = 0; i < 320; i++) {
+        seed = seed * 1103515245 + 12345;
+        block[i] = (int16_t)(4000.0 * sin(2.0 * M_PI * 440.0 * i / 16000.0)) +
+                   (int16_t)((seed >> 16) % 512 - 256);
+    }
+
+    vad_state_t vad;
+    vad_init(&vad);
+
+    lat_buf_t l = {0};
+    uint64_t start = aios_stats_now_us();
+    for (int i = 0; i < 100000; i++) {
+        uint64_t t0 = aios_stats_now_us();
+        vad_process(&vad, block, 320);
+        lat_add(&l, aios_stats_now_us() - t0);
+    }
+    report("vad_block_16k", &l, (aios_stats_now_us() - start) / 1e6,
+           sizeof(block));
+}
+
+/* ==================== Main ==================== */
+
+int main(void) {
+    fprintf(stderr, "[BENCH] AI-OS microbenchmarks\n");
+
+    bench_hal();
+    bench_cjson();
+    bench_framing();
+    bench_vad();
+
+    /* Loopback IPC server for round-trip benches */
+    if (aios_ipc_server_init(&g_server, BENCH_SOCKET, g_bench_cmds) < 0) {
+        perror("aios_ipc_server_init");
+        return 1;
+    }
+    pthread_t server;
+    pthread_create(&server, NULL, server_thread, NULL);
+
+    bench_ipc_rtt(1, 20000);
+    bench_ipc_rtt(4, 10000);
+    bench_ipc_rtt(8, 5000);
+
+    /* Kick the accept loop awake so it notices shutdown */
+    g_server_running = 0;
+    aios_ipc_t kick;
+    aios_ipc_init(&kick, BENCH_SOCKET);
+    aios_ipc_connect(&kick);
+    aios_ipc_close(&kick);
+    pthread_join(server, NULL);
+    aios_ipc_server_close(&g_server);
+
+    return 0;
+}
@@ -0,0 +1,294 @@
+/**
+ * AI-OS IPC Replay Harness
+ * Records framed request traffic crossing a daemon socket and plays it
+ * back at speed. Captures taken on real terminals drive the
+ * profile-guided release build (see the release notes in core/Makefile):
+ * replaying them against an instrumented daemon exercises the
+ * parse/dispatch paths the optimizer should favor.
+ *
+ * Record (proxies the live socket in place, Ctrl-C restores it):
+ *   aios-replay record /run/aios/agent.sock agent.cap
+ *
+ * Replay (speedup 0 = as fast as possible):
+ *   aios-replay replay /run/aios/agent.sock agent.cap 10
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "ipc.h"
+
+#define REPLAY_MAX      65536
+#define CAPTURE_MAGIC   0x41495243u     /* "AIRC" */
+#define CAPTURE_VERSION 1
+
+/* Record types: a connection boundary, then its request frames */
+#define REC_CONNECT 0
+#define REC_FRAME   1
+
+static volatile int g_running = 1;
+
+static void signal_handler(int sig) {
+    (void)sig;
+    g_running = 0;
+}
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* ==================== Framing ==================== */
+
+/* Read one complete frame, preserving its exact length */
+static int read_frame(int fd, char *buf, size_t cap, uint32_t *len_out) {
+    uint32_t len;
+    size_t got = 0;
+    while (got < 4) {
+        ssize_t n = recv(fd, (char *)&len + got, 4 - got, 0);
+        if (n <= 0) return -1;
+        got += n;
+    }
+    len = ntohl(len);
+    if (len >= cap) return -1;
+
+    size_t received = 0;
+    while (received < len) {
+        ssize_t n = recv(fd, buf + received, len - received, 0);
+        if (n <= 0) return -1;
+        received += n;
+    }
+    buf[len] = '\0';
+    *len_out = len;
+    return 0;
+}
+
+static int unix_connect(const char *path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Forward response frames upstream -> client until the final one
+ * (streamed responses are marked "status":"partial" until then) */
+static int forward_response(int upstream, int client, char *buf) {
+    uint32_t len;
+    do {
+        if (read_frame(upstream, buf, REPLAY_MAX, &len) < 0) return -1;
+        if (client >= 0 &&
+            aios_ipc_send_frame(client, buf, len) < 0) return -1;
+    } while (strstr(buf, "\"status\":\"partial\""));
+    return 0;
+}
+
+/* ==================== Record ==================== */
+
+/*
+ * The daemon keeps its bound socket when the path is renamed, so the
+ * recorder slides in as a proxy: the live socket moves to <path>.orig,
+ * the recorder listens at the original path and forwards both ways,
+ * logging client->daemon frames with inter-arrival times. One client
+ * at a time; subscriber push traffic is not captured.
+ */
+static int run_record(const char *path, const char *capfile) {
+    char orig[108];
+    snprintf(orig, sizeof(orig), "%s.orig", path);
+
+    if (rename(path, orig) < 0) {
+        perror("rename");
+        return 1;
+    }
+
+    FILE *cap = fopen(capfile, "wb");
+    if (!cap) {
+        perror("fopen");
+        rename(orig, path);
+        return 1;
+    }
+    uint32_t header[2] = { CAPTURE_MAGIC, CAPTURE_VERSION };
+    fwrite(header, sizeof(header), 1, cap);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (listener < 0 ||
+        bind(listener, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        fclose(cap);
+        rename(orig, path);
+        return 1;
+    }
+    chmod(path, 0666);
+    listen(listener, 16);
+
+    printf("[REPLAY] Recording %s to %s (Ctrl-C to stop)\n", path, capfile);
+
+    char *buf = malloc(REPLAY_MAX);
+    char *rbuf = malloc(REPLAY_MAX);
+    uint64_t last = now_ms();
+    int frames = 0;
+
+    while (g_running && buf && rbuf) {
+        int client = accept(listener, NULL, NULL);
+        if (client < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        int upstream = unix_connect(orig);
+        if (upstream < 0) {
+            close(client);
+            break;
+        }
+
+        fputc(REC_CONNECT, cap);
+
+        uint32_t len;
+        while (g_running && read_frame(client, buf, REPLAY_MAX, &len) == 0) {
+            uint64_t now = now_ms();
+            uint32_t delta = (uint32_t)(now - last);
+            last = now;
+
+            fputc(REC_FRAME, cap);
+            fwrite(&delta, sizeof(delta), 1, cap);
+            fwrite(&len, sizeof(len), 1, cap);
+            fwrite(buf, 1, len, cap);
+            frames++;
+
+            if (aios_ipc_send_frame(upstream, buf, len) < 0 ||
+                forward_response(upstream, client, rbuf) < 0) {
+                break;
+            }
+        }
+
+        close(upstream);
+        close(client);
+    }
+
+    free(buf);
+    free(rbuf);
+    close(listener);
+    unlink(path);
+    rename(orig, path);
+    fclose(cap);
+
+    printf("[REPLAY] Captured %d frames\n", frames);
+    return 0;
+}
+
+/* ==================== Replay ==================== */
+
+static int run_replay(const char *path, const char *capfile, int speedup) {
+    FILE *cap = fopen(capfile, "rb");
+    if (!cap) {
+        perror("fopen");
+        return 1;
+    }
+
+    uint32_t header[2];
+    if (fread(header, sizeof(header), 1, cap) != 1 ||
+        header[0] != CAPTURE_MAGIC || header[1] != CAPTURE_VERSION) {
+        fprintf(stderr, "Not a capture file: %s\n", capfile);
+        fclose(cap);
+        return 1;
+    }
+
+    char *buf = malloc(REPLAY_MAX);
+    char *rbuf = malloc(REPLAY_MAX);
+    int fd = -1, frames = 0, type;
+    uint64_t start = now_ms();
+
+    while (g_running && buf && rbuf && (type = fgetc(cap)) != EOF) {
+        if (type == REC_CONNECT) {
+            if (fd >= 0) close(fd);
+            fd = unix_connect(path);
+            if (fd < 0) {
+                perror("connect");
+                break;
+            }
+            continue;
+        }
+
+        uint32_t delta, len;
+        if (fread(&delta, sizeof(delta), 1, cap) != 1 ||
+            fread(&len, sizeof(len), 1, cap) != 1 ||
+            len >= REPLAY_MAX ||
+            fread(buf, 1, len, cap) != len) {
+            fprintf(stderr, "Truncated capture\n");
+            break;
+        }
+
+        if (speedup > 0 && delta > 0) {
+            usleep((useconds_t)delta * 1000 / speedup);
+        }
+
+        if (fd < 0 ||
+            aios_ipc_send_frame(fd, buf, len) < 0 ||
+            forward_response(fd, -1, rbuf) < 0) {
+            fprintf(stderr, "Daemon dropped the connection\n");
+            break;
+        }
+        frames++;
+    }
+
+    if (fd >= 0) close(fd);
+    free(buf);
+    free(rbuf);
+    fclose(cap);
+
+    double secs = (now_ms() - start) / 1000.0;
+    printf("[REPLAY] Replayed %d frames in %.2fs (%.0f/sec)\n",
+           frames, secs, secs > 0 ? frames / secs : 0);
+    return 0;
+}
+
+/* ==================== Main ==================== */
+
+static void usage(void) {
+    printf("Usage: aios-replay record <socket> <capture>\n");
+    printf("       aios-replay replay <socket> <capture> [speedup]\n");
+    printf("\n");
+    printf("speedup scales recorded inter-arrival times (0 = no delays)\n");
+}
+
+int main(int argc, char *argv[]) {
+    /* No SA_RESTART: Ctrl-C must break out of accept/recv */
+    struct sigaction sa = {0};
+    sa.sa_handler = signal_handler;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (argc >= 4 && strcmp(argv[1], "record") == 0) {
+        return run_record(argv[2], argv[3]);
+    }
+    if (argc >= 4 && strcmp(argv[1], "replay") == 0) {
+        int speedup = argc > 4 ? atoi(argv[4]) : 1;
+        return run_replay(argv[2], argv[3], speedup);
+    }
+
+    usage();
+    return 1;
+}
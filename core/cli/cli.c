@@ -2,18 +2,19 @@
  * AI-OS CLI Tool
  * Command-line interface for AI-OS in C.
  * 
- * Compile: gcc -o aios cli.c -lcjson
+ * Compile: gcc -o aios cli.c -I../ipc -L../ipc -laios-ipc
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <sys/socket.h>
-#include <sys/un.h>
+#include <dirent.h>
 #include <readline/readline.h>
 #include <readline/history.h>
 
+#include "ipc.h"
+
 #define AGENT_SOCKET "/run/aios/agent.sock"
 #define VERSION "1.0.0"
 
@@ -28,48 +29,42 @@
 
 /* ==================== IPC ==================== */
 
+/* One connection for the whole session; reconnects live in libaios-ipc */
+static aios_ipc_t g_agent;
+
 static int send_to_agent(const char *message, char *response, size_t response_size) {
-    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (sock < 0) {
-        strcpy(response, "{\"error\":\"Failed to create socket\"}");
-        return -1;
-    }
-    
-    struct sockaddr_un addr = {0};
-    addr.sun_family = AF_UNIX;
-    strncpy(addr.sun_path, AGENT_SOCKET, sizeof(addr.sun_path) - 1);
-    
-    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-        close(sock);
+    if (aios_ipc_request(&g_agent, message, response, response_size) < 0) {
         strcpy(response, "{\"error\":\"Agent not running\"}");
         return -1;
     }
-    
-    /* Send message */
-    uint32_t len = htonl(strlen(message));
-    send(sock, &len, 4, 0);
-    send(sock, message, strlen(message), 0);
-    
-    /* Receive response */
-    if (recv(sock, &len, 4, 0) != 4) {
-        close(sock);
-        strcpy(response, "{\"error\":\"No response\"}");
+    return 0;
+}
+
+static void print_delta(const char *delta, void *userdata) {
+    int *deltas = userdata;
+    if (*deltas == 0) printf("\n" COLOR_GREEN);
+    fputs(delta, stdout);
+    fflush(stdout);
+    (*deltas)++;
+}
+
+/*
+ * Streaming variant: prints partial-response deltas as they arrive and
+ * returns the final response frame. Returns the number of deltas printed,
+ * or -1 on error.
+ */
+static int send_to_agent_stream(const char *message, char *response, size_t response_size) {
+    int deltas = 0;
+    if (aios_ipc_request_stream(&g_agent, message, response, response_size,
+                                print_delta, &deltas) < 0) {
+        strcpy(response, "{\"error\":\"Agent not running\"}");
         return -1;
     }
-    len = ntohl(len);
-    
-    if (len >= response_size) len = response_size - 1;
-    
-    size_t received = 0;
-    while (received < len) {
-        ssize_t n = recv(sock, response + received, len - received, 0);
-        if (n <= 0) break;
-        received += n;
+
+    if (deltas > 0) {
+        printf(COLOR_RESET "\n");
     }
-    response[received] = '\0';
-    
-    close(sock);
-    return 0;
+    return deltas;
 }
 
 /* ==================== Commands ==================== */
@@ -110,27 +105,31 @@ static void cmd_status(void) {
 
 static void cmd_chat(const char *text) {
     char message[4096];
-    snprintf(message, sizeof(message), "{\"cmd\":\"chat\",\"text\":\"%s\"}", text);
-    
+    snprintf(message, sizeof(message), "{\"cmd\":\"chat\",\"text\":\"%s\",\"stream\":true}", text);
+
     char response[8192];
-    if (send_to_agent(message, response, sizeof(response)) < 0) {
+    int deltas = send_to_agent_stream(message, response, sizeof(response));
+    if (deltas < 0) {
         printf(COLOR_RED "Error: %s" COLOR_RESET "\n", response);
         return;
     }
-    
-    /* Extract response text */
-    char *p = strstr(response, "\"response\":\"");
-    if (p) {
-        p += 12;
-        char *end = strchr(p, '"');
-        if (end) {
-            *end = '\0';
-            printf("\n" COLOR_GREEN "%s" COLOR_RESET "\n", p);
+
+    /* Already rendered token-by-token if any deltas arrived; otherwise
+     * (local fallback, cached answers) print the final response text */
+    if (deltas == 0) {
+        char *p = strstr(response, "\"response\":\"");
+        if (p) {
+            p += 12;
+            char *end = strchr(p, '"');
+            if (end) {
+                *end = '\0';
+                printf("\n" COLOR_GREEN "%s" COLOR_RESET "\n", p);
+            }
         }
     }
     
     /* Check for action result */
-    p = strstr(response, "\"action_result\":");
+    char *p = strstr(response, "\"action_result\":");
     if (p) {
         if (strstr(p, "\"success\":true")) {
             char *msg = strstr(p, "\"message\":\"");
@@ -180,6 +179,204 @@ static void cmd_help(void) {
     printf("  " COLOR_GREEN "exit" COLOR_RESET "         Exit shell\n\n");
 }
 
+/* ==================== Daemon Stats ==================== */
+
+static void format_us(unsigned long long us, char *buf, size_t size) {
+    if (us < 1000) snprintf(buf, size, "%lluus", us);
+    else if (us < 1000000) snprintf(buf, size, "%llums", us / 1000);
+    else snprintf(buf, size, "%.1fs", (double)us / 1000000.0);
+}
+
+/* Upper bound (us) of the histogram bucket holding the pth percentile */
+static unsigned long long stats_percentile(aios_stats_op_t *op,
+                                           unsigned long long count, int pct) {
+    unsigned long long target = (count * pct + 99) / 100;
+    unsigned long long cum = 0;
+    for (int b = 0; b < AIOS_STATS_BUCKETS; b++) {
+        cum += atomic_load_explicit(&op->buckets[b], memory_order_relaxed);
+        if (cum >= target) return 2ULL << b;
+    }
+    return 2ULL << (AIOS_STATS_BUCKETS - 1);
+}
+
+static void dump_stats_page(const char *daemon, const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return;
+
+    aios_stats_page_t page;
+    size_t got = fread(&page, 1, sizeof(page), f);
+    fclose(f);
+
+    if (got != sizeof(page) || page.magic != AIOS_STATS_MAGIC) return;
+
+    printf("\n" COLOR_CYAN "%s" COLOR_RESET "\n", daemon);
+    printf("  %-12s %10s %8s %8s %8s %10s %10s\n",
+           "op", "count", "avg", "p50", "p99", "bytes_in", "bytes_out");
+
+    for (uint32_t i = 0; i < page.op_count && i < AIOS_STATS_MAX_OPS; i++) {
+        aios_stats_op_t *op = &page.ops[i];
+        unsigned long long count =
+            atomic_load_explicit(&op->count, memory_order_relaxed);
+        unsigned long long total =
+            atomic_load_explicit(&op->total_us, memory_order_relaxed);
+
+        char avg[16] = "-", p50[16] = "-", p99[16] = "-";
+        if (count > 0) {
+            format_us(total / count, avg, sizeof(avg));
+            format_us(stats_percentile(op, count, 50), p50, sizeof(p50));
+            format_us(stats_percentile(op, count, 99), p99, sizeof(p99));
+        }
+
+        printf("  %-12s %10llu %8s %8s %8s %10llu %10llu\n",
+               op->name, count, avg, p50, p99,
+               (unsigned long long)atomic_load_explicit(&op->bytes_in,
+                                                        memory_order_relaxed),
+               (unsigned long long)atomic_load_explicit(&op->bytes_out,
+                                                        memory_order_relaxed));
+    }
+}
+
+static void cmd_stats(void) {
+    DIR *dir = opendir("/dev/shm");
+    if (!dir) {
+        printf(COLOR_RED "Cannot open /dev/shm" COLOR_RESET "\n");
+        return;
+    }
+
+    int found = 0;
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (strncmp(ent->d_name, "aios-stats-", 11) != 0) continue;
+
+        char path[512];
+        snprintf(path, sizeof(path), "/dev/shm/%s", ent->d_name);
+        dump_stats_page(ent->d_name + 11, path);
+        found++;
+    }
+    closedir(dir);
+
+    if (!found) {
+        printf("No stats pages in /dev/shm (are the daemons running?)\n");
+    } else {
+        printf("\n");
+    }
+}
+
+/* ==================== Batch Mode ==================== */
+
+/*
+ * aios batch < commands.txt: one connection, framed requests pipelined
+ * up to BATCH_WINDOW deep without waiting for each response. Every
+ * request carries a sequence id the agent echoes back, and responses
+ * are printed as "<id>\t<json>" lines for scripts to consume.
+ */
+
+#define BATCH_WINDOW 32
+
+static void batch_build_msg(const char *line, int id, char *msg, size_t size) {
+    if (line[0] == '{') {
+        /* Raw JSON object: inject the sequence id */
+        if (line[1] == '}') {
+            snprintf(msg, size, "{\"id\":%d}", id);
+        } else {
+            snprintf(msg, size, "{\"id\":%d,%s", id, line + 1);
+        }
+    }
+    else if (strcmp(line, "status") == 0) {
+        snprintf(msg, size, "{\"id\":%d,\"cmd\":\"status\"}", id);
+    }
+    else if (strcmp(line, "clear") == 0) {
+        snprintf(msg, size, "{\"id\":%d,\"cmd\":\"clear\"}", id);
+    }
+    else if (strncmp(line, "action ", 7) == 0) {
+        char type[64] = "";
+        sscanf(line + 7, "%63s", type);
+
+        const char *params = line + 7 + strlen(type);
+        while (*params == ' ') params++;
+
+        if (*params) {
+            snprintf(msg, size,
+                "{\"id\":%d,\"cmd\":\"action\",\"action\":{\"action\":\"%s\",%s}}",
+                id, type, params);
+        } else {
+            snprintf(msg, size,
+                "{\"id\":%d,\"cmd\":\"action\",\"action\":{\"action\":\"%s\"}}",
+                id, type);
+        }
+    }
+    else {
+        const char *text = strncmp(line, "chat ", 5) == 0 ? line + 5 : line;
+        snprintf(msg, size, "{\"id\":%d,\"cmd\":\"chat\",\"text\":\"%s\"}", id, text);
+    }
+}
+
+static int batch_read_response(int fd) {
+    char response[8192];
+    if (aios_ipc_recv_frame(fd, response, sizeof(response)) < 0) return -1;
+
+    int id = -1;
+    char *p = strstr(response, "\"id\":");
+    if (p) sscanf(p, "\"id\":%d", &id);
+
+    printf("%d\t%s\n", id, response);
+    return 0;
+}
+
+static int run_batch(void) {
+    int fd = aios_ipc_connect(&g_agent);
+    if (fd < 0) {
+        fprintf(stderr, COLOR_RED "Agent not running" COLOR_RESET "\n");
+        return 1;
+    }
+
+    char line[4096];
+    int sent = 0, answered = 0, failed = 0;
+
+    while (fgets(line, sizeof(line), stdin)) {
+        line[strcspn(line, "\n")] = '\0';
+
+        char *p = line;
+        while (*p == ' ') p++;
+        if (!*p || *p == '#') continue;
+
+        char msg[8192];
+        batch_build_msg(p, sent + 1, msg, sizeof(msg));
+
+        if (aios_ipc_send_frame(fd, msg, strlen(msg)) < 0) {
+            failed = 1;
+            break;
+        }
+        sent++;
+
+        /* Keep the pipeline bounded so neither side's buffers fill up */
+        if (sent - answered >= BATCH_WINDOW) {
+            if (batch_read_response(fd) < 0) {
+                failed = 1;
+                break;
+            }
+            answered++;
+        }
+    }
+
+    while (!failed && answered < sent) {
+        if (batch_read_response(fd) < 0) {
+            failed = 1;
+            break;
+        }
+        answered++;
+    }
+
+    if (failed) {
+        fprintf(stderr, COLOR_RED "Batch aborted after %d/%d responses"
+            COLOR_RESET "\n", answered, sent);
+        return 1;
+    }
+
+    fprintf(stderr, "%d commands completed\n", sent);
+    return 0;
+}
+
 /* ==================== Interactive Shell ==================== */
 
 static void run_shell(void) {
@@ -265,13 +462,17 @@ static void usage(void) {
     printf("Commands:\n");
     printf("  shell          Interactive shell (default)\n");
     printf("  status         Show system status\n");
+    printf("  stats          Show per-daemon latency counters\n");
     printf("  chat <text>    Chat with AI\n");
     printf("  action <type>  Execute action\n");
+    printf("  batch          Pipeline commands from stdin, one per line\n");
     printf("  --version      Show version\n");
     printf("  --help         Show this help\n");
 }
 
 int main(int argc, char *argv[]) {
+    aios_ipc_init(&g_agent, AGENT_SOCKET);
+
     if (argc < 2) {
         run_shell();
         return 0;
@@ -290,9 +491,15 @@ int main(int argc, char *argv[]) {
     if (strcmp(argv[1], "shell") == 0) {
         run_shell();
     }
+    else if (strcmp(argv[1], "batch") == 0) {
+        return run_batch();
+    }
     else if (strcmp(argv[1], "status") == 0) {
         cmd_status();
     }
+    else if (strcmp(argv[1], "stats") == 0) {
+        cmd_stats();
+    }
     else if (strcmp(argv[1], "chat") == 0 && argc > 2) {
         /* Concatenate remaining args */
         char text[1024] = "";
@@ -12,31 +12,25 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <dirent.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <sys/sysinfo.h>
 #include <sys/statvfs.h>
 #include <sys/utsname.h>
 #include <sys/reboot.h>
 #include <linux/reboot.h>
+#include <linux/rfkill.h>
 #include <errno.h>
+#include <alsa/asoundlib.h>
 
 #include "hal.h"
 
 /* ==================== Helper Functions ==================== */
 
-static int read_sysfs_int(const char *path) {
-    FILE *f = fopen(path, "r");
-    if (!f) return -1;
-    
-    int value;
-    if (fscanf(f, "%d", &value) != 1) {
-        fclose(f);
-        return -1;
-    }
-    fclose(f);
-    return value;
-}
-
 static int write_sysfs_int(const char *path, int value) {
     FILE *f = fopen(path, "w");
     if (!f) return -1;
@@ -46,131 +40,339 @@ static int write_sysfs_int(const char *path, int value) {
     return 0;
 }
 
-static int read_sysfs_str(const char *path, char *buf, size_t len) {
-    FILE *f = fopen(path, "r");
-    if (!f) return -1;
-    
-    if (!fgets(buf, len, f)) {
-        fclose(f);
-        return -1;
-    }
-    
-    /* Remove trailing newline */
-    size_t l = strlen(buf);
-    if (l > 0 && buf[l-1] == '\n') buf[l-1] = '\0';
-    
-    fclose(f);
-    return 0;
-}
+/* ==================== Device Registry ==================== */
+
+/*
+ * Resolved sysfs device paths and attribute fds are cached per process so
+ * hot callers (battery polling, status bar refresh) don't re-scan
+ * the /sys/class dirs and re-open files on every read. Cached attributes are
+ * re-read with pread() at offset 0 on a held fd. An inotify watch on the
+ * class directories invalidates the cache on hotplug, and a failed pread
+ * forces a re-resolve as a fallback.
+ */
+
+enum {
+    ATTR_BRIGHTNESS,
+    ATTR_MAX_BRIGHTNESS,
+    ATTR_BAT_PRESENT,
+    ATTR_BAT_CAPACITY,
+    ATTR_BAT_STATUS,
+    ATTR_BAT_ENERGY_NOW,
+    ATTR_BAT_ENERGY_FULL,
+    ATTR_BAT_POWER_NOW,
+    ATTR_AC_ONLINE,
+    ATTR_COUNT
+};
+
+/* Attribute file names, relative to the owning device directory */
+static const char *ATTR_NAMES[ATTR_COUNT] = {
+    "brightness", "max_brightness",
+    "present", "capacity", "status", "energy_now", "energy_full", "power_now",
+    "online"
+};
+
+static struct {
+    char backlight[256];        /* device dir, "" = not found */
+    char battery[256];
+    char ac[256];
+    int fds[ATTR_COUNT];        /* -1 = attribute unavailable */
+    int inotify_fd;
+    bool valid;
+} g_registry = { .inotify_fd = -1 };
+
+static pthread_once_t g_registry_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t g_registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Find the first entry in a sysfs class dir matching one of two prefixes;
+ * NULL prefix matches any non-hidden entry. */
+static int scan_class_dir(const char *class_dir, const char *prefix1,
+                          const char *prefix2, char *out, size_t out_len) {
+    out[0] = '\0';
+    DIR *dir = opendir(class_dir);
+    if (!dir) return -1;
 
-static char *find_backlight_device(void) {
-    static char path[256];
-    DIR *dir = opendir("/sys/class/backlight");
-    if (!dir) return NULL;
-    
     struct dirent *entry;
     while ((entry = readdir(dir)) != NULL) {
-        if (entry->d_name[0] != '.') {
-            snprintf(path, sizeof(path), "/sys/class/backlight/%s", entry->d_name);
-            closedir(dir);
-            return path;
-        }
+        if (entry->d_name[0] == '.') continue;
+        if (prefix1 && strncmp(entry->d_name, prefix1, strlen(prefix1)) != 0 &&
+            (!prefix2 || strncmp(entry->d_name, prefix2, strlen(prefix2)) != 0))
+            continue;
+        snprintf(out, out_len, "%s/%s", class_dir, entry->d_name);
+        closedir(dir);
+        return 0;
     }
     closedir(dir);
-    return NULL;
+    return -1;
 }
 
-static char *find_battery_device(void) {
-    static char path[256];
-    DIR *dir = opendir("/sys/class/power_supply");
-    if (!dir) return NULL;
-    
-    struct dirent *entry;
-    while ((entry = readdir(dir)) != NULL) {
-        if (strncmp(entry->d_name, "BAT", 3) == 0) {
-            snprintf(path, sizeof(path), "/sys/class/power_supply/%s", entry->d_name);
-            closedir(dir);
-            return path;
-        }
+/* Open one attribute fd under a device dir; -1 if either is missing */
+static int open_attr(const char *device, const char *name) {
+    if (!device[0]) return -1;
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", device, name);
+    return open(path, O_RDONLY | O_CLOEXEC);
+}
+
+/* Re-scan devices and re-open attribute fds; caller holds registry mutex */
+static void registry_resolve(void) {
+    for (int i = 0; i < ATTR_COUNT; i++) {
+        if (g_registry.fds[i] >= 0) close(g_registry.fds[i]);
+        g_registry.fds[i] = -1;
     }
-    closedir(dir);
-    return NULL;
+
+    scan_class_dir("/sys/class/backlight", NULL, NULL,
+                   g_registry.backlight, sizeof(g_registry.backlight));
+    scan_class_dir("/sys/class/power_supply", "BAT", NULL,
+                   g_registry.battery, sizeof(g_registry.battery));
+    scan_class_dir("/sys/class/power_supply", "AC", "ADP",
+                   g_registry.ac, sizeof(g_registry.ac));
+
+    for (int i = ATTR_BRIGHTNESS; i <= ATTR_MAX_BRIGHTNESS; i++)
+        g_registry.fds[i] = open_attr(g_registry.backlight, ATTR_NAMES[i]);
+    for (int i = ATTR_BAT_PRESENT; i <= ATTR_BAT_POWER_NOW; i++)
+        g_registry.fds[i] = open_attr(g_registry.battery, ATTR_NAMES[i]);
+    g_registry.fds[ATTR_AC_ONLINE] = open_attr(g_registry.ac, ATTR_NAMES[ATTR_AC_ONLINE]);
+
+    g_registry.valid = true;
+}
+
+static void registry_init(void) {
+    for (int i = 0; i < ATTR_COUNT; i++) g_registry.fds[i] = -1;
+
+    g_registry.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (g_registry.inotify_fd >= 0) {
+        inotify_add_watch(g_registry.inotify_fd, "/sys/class/backlight",
+                          IN_CREATE | IN_DELETE);
+        inotify_add_watch(g_registry.inotify_fd, "/sys/class/power_supply",
+                          IN_CREATE | IN_DELETE);
+    }
+
+    pthread_mutex_lock(&g_registry_mutex);
+    registry_resolve();
+    pthread_mutex_unlock(&g_registry_mutex);
+}
+
+/* Lock the registry, re-resolving first if hotplug invalidated it */
+static void registry_lock(void) {
+    pthread_once(&g_registry_once, registry_init);
+    pthread_mutex_lock(&g_registry_mutex);
+
+    if (g_registry.inotify_fd >= 0) {
+        char buf[1024];
+        bool changed = false;
+        while (read(g_registry.inotify_fd, buf, sizeof(buf)) > 0)
+            changed = true;
+        if (changed) g_registry.valid = false;
+    }
+    if (!g_registry.valid) registry_resolve();
+}
+
+static void registry_unlock(void) {
+    pthread_mutex_unlock(&g_registry_mutex);
+}
+
+/* pread an integer attribute from its held fd; caller holds mutex */
+static int attr_pread_int(int attr) {
+    int fd = g_registry.fds[attr];
+    if (fd < 0) return -1;
+
+    char buf[32];
+    ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) return -1;
+    buf[n] = '\0';
+    return atoi(buf);
+}
+
+/* pread a string attribute, trimming the trailing newline; caller holds mutex */
+static int attr_pread_str(int attr, char *out, size_t out_len) {
+    int fd = g_registry.fds[attr];
+    if (fd < 0) return -1;
+
+    char buf[128];
+    ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) return -1;
+    buf[n] = '\0';
+    if (n > 0 && buf[n-1] == '\n') buf[n-1] = '\0';
+
+    strncpy(out, buf, out_len - 1);
+    out[out_len - 1] = '\0';
+    return 0;
+}
+
+/* Read an integer attribute, re-resolving once if the fd went stale */
+static int attr_read_int(int attr) {
+    int value = attr_pread_int(attr);
+    if (value < 0) {
+        registry_resolve();
+        value = attr_pread_int(attr);
+    }
+    return value;
 }
 
 /* ==================== Display Implementation ==================== */
 
 int hal_brightness_get(void) {
-    char *device = find_backlight_device();
-    if (!device) return -1;
-    
-    char brightness_path[512], max_path[512];
-    snprintf(brightness_path, sizeof(brightness_path), "%s/brightness", device);
-    snprintf(max_path, sizeof(max_path), "%s/max_brightness", device);
-    
-    int current = read_sysfs_int(brightness_path);
-    int max = read_sysfs_int(max_path);
-    
+    registry_lock();
+    int current = attr_read_int(ATTR_BRIGHTNESS);
+    int max = attr_read_int(ATTR_MAX_BRIGHTNESS);
+    registry_unlock();
+
     if (current < 0 || max <= 0) return -1;
-    
+
     return (current * 100) / max;
 }
 
 int hal_brightness_set(int level) {
     if (level < 0) level = 0;
     if (level > 100) level = 100;
-    
-    char *device = find_backlight_device();
-    if (!device) return -1;
-    
-    char brightness_path[512], max_path[512];
-    snprintf(brightness_path, sizeof(brightness_path), "%s/brightness", device);
-    snprintf(max_path, sizeof(max_path), "%s/max_brightness", device);
-    
-    int max = read_sysfs_int(max_path);
+
+    registry_lock();
+    int max = attr_read_int(ATTR_MAX_BRIGHTNESS);
+
+    char brightness_path[512];
+    snprintf(brightness_path, sizeof(brightness_path), "%s/brightness",
+             g_registry.backlight);
+    registry_unlock();
+
     if (max <= 0) return -1;
-    
+
     int value = (max * level) / 100;
     return write_sysfs_int(brightness_path, value);
 }
 
 /* ==================== Audio Implementation ==================== */
 
+/*
+ * Volume and mute go through one persistent ALSA mixer handle on the
+ * Master element, so each call is a library round-trip instead of a
+ * fork+exec of amixer (volume hotkeys fire these dozens of times a
+ * second). snd_mixer_handle_events() is pumped before every read so
+ * changes made by other clients are picked up. If the handle dies
+ * (device unplugged, sound server restart) it is dropped and reopened
+ * on the next call.
+ */
+
+static snd_mixer_t *g_mixer = NULL;
+static snd_mixer_elem_t *g_mixer_elem = NULL;
+static pthread_mutex_t g_mixer_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Drop a dead mixer handle; caller holds mutex */
+static void mixer_close(void) {
+    if (g_mixer) snd_mixer_close(g_mixer);
+    g_mixer = NULL;
+    g_mixer_elem = NULL;
+}
+
+/* Open the mixer and find Master, if not already open; caller holds mutex */
+static int mixer_open(void) {
+    if (g_mixer_elem) {
+        /* Pick up volume changes made by other mixer clients */
+        if (snd_mixer_handle_events(g_mixer) < 0) mixer_close();
+    }
+    if (g_mixer_elem) return 0;
+
+    snd_mixer_t *mixer;
+    if (snd_mixer_open(&mixer, 0) < 0) return -1;
+
+    if (snd_mixer_attach(mixer, "default") < 0 ||
+        snd_mixer_selem_register(mixer, NULL, NULL) < 0 ||
+        snd_mixer_load(mixer) < 0) {
+        snd_mixer_close(mixer);
+        return -1;
+    }
+
+    snd_mixer_selem_id_t *sid;
+    snd_mixer_selem_id_alloca(&sid);
+    snd_mixer_selem_id_set_index(sid, 0);
+    snd_mixer_selem_id_set_name(sid, "Master");
+
+    snd_mixer_elem_t *elem = snd_mixer_find_selem(mixer, sid);
+    if (!elem) {
+        snd_mixer_close(mixer);
+        return -1;
+    }
+
+    g_mixer = mixer;
+    g_mixer_elem = elem;
+    return 0;
+}
+
 int hal_volume_get(void) {
-    /* Use amixer to get volume */
-    FILE *fp = popen("amixer get Master 2>/dev/null | grep -o '[0-9]*%' | head -1 | tr -d '%'", "r");
-    if (!fp) return -1;
-    
-    int volume = -1;
-    fscanf(fp, "%d", &volume);
-    pclose(fp);
-    
-    return volume;
+    pthread_mutex_lock(&g_mixer_mutex);
+    if (mixer_open() < 0) {
+        pthread_mutex_unlock(&g_mixer_mutex);
+        return -1;
+    }
+
+    long min, max, value;
+    if (snd_mixer_selem_get_playback_volume_range(g_mixer_elem, &min, &max) < 0 ||
+        snd_mixer_selem_get_playback_volume(g_mixer_elem,
+                                            SND_MIXER_SCHN_FRONT_LEFT, &value) < 0 ||
+        max <= min) {
+        mixer_close();
+        pthread_mutex_unlock(&g_mixer_mutex);
+        return -1;
+    }
+    pthread_mutex_unlock(&g_mixer_mutex);
+
+    return (int)(((value - min) * 100 + (max - min) / 2) / (max - min));
 }
 
 int hal_volume_set(int level) {
     if (level < 0) level = 0;
     if (level > 100) level = 100;
-    
-    char cmd[128];
-    snprintf(cmd, sizeof(cmd), "amixer set Master %d%% >/dev/null 2>&1", level);
-    return system(cmd) == 0 ? 0 : -1;
+
+    pthread_mutex_lock(&g_mixer_mutex);
+    if (mixer_open() < 0) {
+        pthread_mutex_unlock(&g_mixer_mutex);
+        return -1;
+    }
+
+    long min, max;
+    if (snd_mixer_selem_get_playback_volume_range(g_mixer_elem, &min, &max) < 0 ||
+        max <= min ||
+        snd_mixer_selem_set_playback_volume_all(g_mixer_elem,
+            min + ((max - min) * level + 50) / 100) < 0) {
+        mixer_close();
+        pthread_mutex_unlock(&g_mixer_mutex);
+        return -1;
+    }
+    pthread_mutex_unlock(&g_mixer_mutex);
+
+    return 0;
 }
 
 int hal_mute_get(void) {
-    FILE *fp = popen("amixer get Master 2>/dev/null | grep -o '\\[off\\]'", "r");
-    if (!fp) return -1;
-    
-    char buf[16];
-    int muted = (fgets(buf, sizeof(buf), fp) != NULL);
-    pclose(fp);
-    
-    return muted ? 1 : 0;
+    pthread_mutex_lock(&g_mixer_mutex);
+    if (mixer_open() < 0 ||
+        !snd_mixer_selem_has_playback_switch(g_mixer_elem)) {
+        pthread_mutex_unlock(&g_mixer_mutex);
+        return -1;
+    }
+
+    int enabled;
+    if (snd_mixer_selem_get_playback_switch(g_mixer_elem,
+                                            SND_MIXER_SCHN_FRONT_LEFT, &enabled) < 0) {
+        mixer_close();
+        pthread_mutex_unlock(&g_mixer_mutex);
+        return -1;
+    }
+    pthread_mutex_unlock(&g_mixer_mutex);
+
+    return enabled ? 0 : 1;
 }
 
 int hal_mute_set(bool mute) {
-    char cmd[64];
-    snprintf(cmd, sizeof(cmd), "amixer set Master %s >/dev/null 2>&1", mute ? "mute" : "unmute");
-    return system(cmd) == 0 ? 0 : -1;
+    pthread_mutex_lock(&g_mixer_mutex);
+    if (mixer_open() < 0 ||
+        !snd_mixer_selem_has_playback_switch(g_mixer_elem) ||
+        snd_mixer_selem_set_playback_switch_all(g_mixer_elem, mute ? 0 : 1) < 0) {
+        pthread_mutex_unlock(&g_mixer_mutex);
+        return -1;
+    }
+    pthread_mutex_unlock(&g_mixer_mutex);
+
+    return 0;
 }
 
 /* ==================== Power Implementation ==================== */
@@ -178,39 +380,36 @@ int hal_mute_set(bool mute) {
 int hal_battery_get(battery_info_t *info) {
     if (!info) return -1;
     memset(info, 0, sizeof(*info));
-    
-    char *device = find_battery_device();
-    if (!device) {
+
+    registry_lock();
+    if (!g_registry.battery[0]) {
+        registry_unlock();
         info->present = false;
         return 0;
     }
-    
-    char path[512];
-    
+
     /* Check if present */
-    snprintf(path, sizeof(path), "%s/present", device);
-    info->present = (read_sysfs_int(path) == 1);
-    if (!info->present) return 0;
-    
+    info->present = (attr_read_int(ATTR_BAT_PRESENT) == 1);
+    if (!info->present) {
+        registry_unlock();
+        return 0;
+    }
+
     /* Get capacity */
-    snprintf(path, sizeof(path), "%s/capacity", device);
-    info->level = read_sysfs_int(path);
+    info->level = attr_read_int(ATTR_BAT_CAPACITY);
     if (info->level < 0) info->level = 0;
-    
+
     /* Get status */
-    snprintf(path, sizeof(path), "%s/status", device);
-    if (read_sysfs_str(path, info->status, sizeof(info->status)) < 0) {
+    if (attr_pread_str(ATTR_BAT_STATUS, info->status, sizeof(info->status)) < 0) {
         strcpy(info->status, "Unknown");
     }
-    
+
     /* Calculate time estimates */
-    snprintf(path, sizeof(path), "%s/energy_now", device);
-    int energy_now = read_sysfs_int(path);
-    snprintf(path, sizeof(path), "%s/energy_full", device);
-    int energy_full = read_sysfs_int(path);
-    snprintf(path, sizeof(path), "%s/power_now", device);
-    int power_now = read_sysfs_int(path);
-    
+    int energy_now = attr_read_int(ATTR_BAT_ENERGY_NOW);
+    int energy_full = attr_read_int(ATTR_BAT_ENERGY_FULL);
+    int power_now = attr_read_int(ATTR_BAT_POWER_NOW);
+    registry_unlock();
+
     if (power_now > 0) {
         if (strcmp(info->status, "Discharging") == 0) {
             info->time_to_empty = (energy_now * 60) / power_now;
@@ -223,24 +422,14 @@ int hal_battery_get(battery_info_t *info) {
 }
 
 int hal_on_ac_power(void) {
-    DIR *dir = opendir("/sys/class/power_supply");
-    if (!dir) return -1;
-    
-    struct dirent *entry;
-    while ((entry = readdir(dir)) != NULL) {
-        if (strncmp(entry->d_name, "AC", 2) == 0 || 
-            strncmp(entry->d_name, "ADP", 3) == 0) {
-            char path[512];
-            snprintf(path, sizeof(path), "/sys/class/power_supply/%s/online", entry->d_name);
-            int online = read_sysfs_int(path);
-            if (online == 1) {
-                closedir(dir);
-                return 1;
-            }
-        }
-    }
-    closedir(dir);
-    return 0;
+    registry_lock();
+    int online = attr_read_int(ATTR_AC_ONLINE);
+    registry_unlock();
+
+    if (online >= 0) return online == 1 ? 1 : 0;
+
+    /* No adapter attribute; report unplugged unless sysfs itself is gone */
+    return access("/sys/class/power_supply", F_OK) == 0 ? 0 : -1;
 }
 
 int hal_suspend(void) {
@@ -263,38 +452,88 @@ int hal_reboot(void) {
 
 /* ==================== Network Implementation ==================== */
 
+/*
+ * Radio state goes through /dev/rfkill: on open the kernel dumps the
+ * current state of every switch, and a CHANGE_ALL write flips all
+ * switches of a type, so queries and toggles are a single read/write
+ * instead of a 50-300ms nmcli/bluetoothctl fork plus text parsing.
+ * nmcli/bluetoothctl remain as fallbacks for systems without rfkill.
+ */
+
+/* Query radio state for one rfkill type; 1 unblocked, 0 blocked, -1 unknown */
+static int rfkill_get(int type) {
+    int fd = open("/dev/rfkill", O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    struct rfkill_event ev;
+    int state = -1;
+    ssize_t n;
+    while ((n = read(fd, &ev, sizeof(ev))) >= (ssize_t)RFKILL_EVENT_SIZE_V1) {
+        if (ev.type == type && ev.op == RFKILL_OP_ADD)
+            state = (!ev.soft && !ev.hard) ? 1 : 0;
+    }
+    close(fd);
+    return state;
+}
+
+/* Soft-block or unblock all switches of one rfkill type */
+static int rfkill_set(int type, bool enabled) {
+    int fd = open("/dev/rfkill", O_RDWR | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    struct rfkill_event ev = {0};
+    ev.op = RFKILL_OP_CHANGE_ALL;
+    ev.type = type;
+    ev.soft = enabled ? 0 : 1;
+
+    ssize_t n = write(fd, &ev, sizeof(ev));
+    close(fd);
+    return n == sizeof(ev) ? 0 : -1;
+}
+
 int hal_wifi_enabled(void) {
+    int state = rfkill_get(RFKILL_TYPE_WLAN);
+    if (state >= 0) return state;
+
+    /* No rfkill switch: fall back to NetworkManager */
     FILE *fp = popen("nmcli radio wifi 2>/dev/null", "r");
     if (!fp) return -1;
-    
+
     char buf[32];
     if (fgets(buf, sizeof(buf), fp) == NULL) {
         pclose(fp);
         return -1;
     }
     pclose(fp);
-    
+
     return (strstr(buf, "enabled") != NULL) ? 1 : 0;
 }
 
 int hal_wifi_set(bool enabled) {
+    if (rfkill_set(RFKILL_TYPE_WLAN, enabled) == 0) return 0;
+
     char cmd[64];
     snprintf(cmd, sizeof(cmd), "nmcli radio wifi %s >/dev/null 2>&1", enabled ? "on" : "off");
     return system(cmd) == 0 ? 0 : -1;
 }
 
 int hal_bluetooth_enabled(void) {
+    int state = rfkill_get(RFKILL_TYPE_BLUETOOTH);
+    if (state >= 0) return state;
+
     FILE *fp = popen("bluetoothctl show 2>/dev/null | grep 'Powered: yes'", "r");
     if (!fp) return -1;
-    
+
     char buf[64];
     int enabled = (fgets(buf, sizeof(buf), fp) != NULL);
     pclose(fp);
-    
+
     return enabled ? 1 : 0;
 }
 
 int hal_bluetooth_set(bool enabled) {
+    if (rfkill_set(RFKILL_TYPE_BLUETOOTH, enabled) == 0) return 0;
+
     char cmd[64];
     snprintf(cmd, sizeof(cmd), "bluetoothctl power %s >/dev/null 2>&1", enabled ? "on" : "off");
     return system(cmd) == 0 ? 0 : -1;
@@ -336,54 +575,336 @@ int hal_system_info(system_info_t *info) {
     return 0;
 }
 
+/* ==================== Metrics Snapshot ==================== */
+
+/*
+ * One publisher (the agent's sampler thread) writes a system_info_t
+ * snapshot into a shared-memory segment guarded by a seqlock; any number
+ * of readers copy it out lock-free and without syscalls. The sequence
+ * counter is odd while a write is in flight, so a torn read is detected
+ * and retried. Readers fall back to hal_system_info() when no publisher
+ * is running or the snapshot has gone stale.
+ */
+
+#define METRICS_SHM_NAME    "/aios-metrics"
+#define METRICS_MAGIC       0x41494d31  /* "AIM1" */
+#define METRICS_VERSION     1
+#define METRICS_MAX_AGE_SEC 10
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seq;               /* seqlock, odd = write in progress */
+    uint32_t pad;
+    uint64_t sampled_at;        /* CLOCK_MONOTONIC seconds */
+    system_info_t info;
+} metrics_shm_t;
+
+static metrics_shm_t *g_metrics_wr = NULL;  /* publisher mapping (RW) */
+static metrics_shm_t *g_metrics_rd = NULL;  /* reader mapping (RO) */
+
+static uint64_t monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec;
+}
+
+int hal_metrics_publish(void) {
+    if (!g_metrics_wr) {
+        int fd = shm_open(METRICS_SHM_NAME, O_CREAT | O_RDWR, 0644);
+        if (fd < 0) return -1;
+        if (ftruncate(fd, sizeof(metrics_shm_t)) < 0) {
+            close(fd);
+            return -1;
+        }
+        void *map = mmap(NULL, sizeof(metrics_shm_t), PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) return -1;
+        g_metrics_wr = map;
+        g_metrics_wr->magic = METRICS_MAGIC;
+        g_metrics_wr->version = METRICS_VERSION;
+    }
+
+    system_info_t info;
+    if (hal_system_info(&info) < 0) return -1;
+
+    metrics_shm_t *m = g_metrics_wr;
+    uint32_t seq = m->seq;
+    __atomic_store_n(&m->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    m->info = info;
+    m->sampled_at = monotonic_seconds();
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&m->seq, seq + 2, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+int hal_system_info_cached(system_info_t *info) {
+    if (!info) return -1;
+
+    if (!g_metrics_rd) {
+        int fd = shm_open(METRICS_SHM_NAME, O_RDONLY, 0);
+        if (fd >= 0) {
+            void *map = mmap(NULL, sizeof(metrics_shm_t), PROT_READ,
+                             MAP_SHARED, fd, 0);
+            close(fd);
+            if (map != MAP_FAILED) g_metrics_rd = map;
+        }
+    }
+
+    metrics_shm_t *m = g_metrics_rd;
+    if (m && m->magic == METRICS_MAGIC && m->version == METRICS_VERSION) {
+        for (int retry = 0; retry < 16; retry++) {
+            uint32_t seq1 = __atomic_load_n(&m->seq, __ATOMIC_ACQUIRE);
+            if (seq1 & 1) continue;
+
+            system_info_t copy = m->info;
+            uint64_t sampled_at = m->sampled_at;
+
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            uint32_t seq2 = __atomic_load_n(&m->seq, __ATOMIC_ACQUIRE);
+            if (seq1 != seq2) continue;
+
+            if (seq1 == 0 ||
+                monotonic_seconds() - sampled_at > METRICS_MAX_AGE_SEC)
+                break;  /* never published, or publisher died */
+
+            *info = copy;
+            return 0;
+        }
+    }
+
+    return hal_system_info(info);
+}
+
 /* ==================== Applications Implementation ==================== */
 
-int hal_app_launch(const char *name) {
-    if (!name) return -1;
-    
-    char cmd[512];
-    
-    /* Try direct command first */
-    snprintf(cmd, sizeof(cmd), "%s >/dev/null 2>&1 &", name);
-    if (system(cmd) == 0) return 0;
-    
-    /* Try gtk-launch */
-    snprintf(cmd, sizeof(cmd), "gtk-launch %s >/dev/null 2>&1 &", name);
-    if (system(cmd) == 0) return 0;
-    
-    /* Search in applications directory */
-    DIR *dir = opendir("/usr/share/applications");
-    if (dir) {
-        struct dirent *entry;
-        while ((entry = readdir(dir)) != NULL) {
-            if (strstr(entry->d_name, name) && strstr(entry->d_name, ".desktop")) {
-                snprintf(cmd, sizeof(cmd), "gtk-launch %s >/dev/null 2>&1 &", entry->d_name);
-                closedir(dir);
-                return system(cmd) == 0 ? 0 : -1;
-            }
+/*
+ * .desktop entries are parsed once into an in-process index (name, exec
+ * line with field codes stripped, keywords) so launches are a lookup
+ * plus a direct fork/exec of the cached Exec line — no shell, no
+ * per-launch directory scan. An inotify watch on the applications dir
+ * triggers a rebuild when entries are installed or removed.
+ */
+
+#define APP_DIR "/usr/share/applications"
+#define APP_MAX 512
+
+typedef struct {
+    char name[128];         /* Name= */
+    char file[128];         /* desktop basename without .desktop */
+    char exec[512];         /* Exec= with %-field codes stripped */
+    char keywords[256];     /* Keywords= */
+} app_entry_t;
+
+static struct {
+    app_entry_t *entries;
+    int count;
+    int inotify_fd;
+    bool valid;
+} g_apps = { .inotify_fd = -1 };
+
+static pthread_once_t g_apps_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t g_apps_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Strip desktop-entry field codes (%f, %u, ...) from an Exec line */
+static void strip_field_codes(char *exec) {
+    char *src = exec, *dst = exec;
+    while (*src) {
+        if (src[0] == '%' && src[1]) {
+            src += 2;
+            continue;
         }
-        closedir(dir);
+        *dst++ = *src++;
     }
-    
-    return -1;
+    while (dst > exec && dst[-1] == ' ') dst--;
+    *dst = '\0';
 }
 
-int hal_app_list(char names[][256], int max_count) {
-    DIR *dir = opendir("/usr/share/applications");
-    if (!dir) return 0;
-    
-    int count = 0;
-    struct dirent *entry;
-    while ((entry = readdir(dir)) != NULL && count < max_count) {
-        if (strstr(entry->d_name, ".desktop")) {
-            /* Remove .desktop extension */
-            strncpy(names[count], entry->d_name, 255);
-            char *ext = strstr(names[count], ".desktop");
-            if (ext) *ext = '\0';
-            count++;
+/* Parse one .desktop file into an index entry; -1 if hidden or unusable */
+static int parse_desktop_file(const char *fname, app_entry_t *app) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", APP_DIR, fname);
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+
+    memset(app, 0, sizeof(*app));
+    strncpy(app->file, fname, sizeof(app->file) - 1);
+    char *ext = strstr(app->file, ".desktop");
+    if (ext) *ext = '\0';
+
+    bool in_entry = false, hidden = false;
+    char line[1024];
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '[') {
+            in_entry = (strcmp(line, "[Desktop Entry]") == 0);
+            continue;
+        }
+        if (!in_entry) continue;
+
+        if (strncmp(line, "Name=", 5) == 0 && !app->name[0]) {
+            strncpy(app->name, line + 5, sizeof(app->name) - 1);
+        } else if (strncmp(line, "Exec=", 5) == 0 && !app->exec[0]) {
+            strncpy(app->exec, line + 5, sizeof(app->exec) - 1);
+            strip_field_codes(app->exec);
+        } else if (strncmp(line, "Keywords=", 9) == 0) {
+            strncpy(app->keywords, line + 9, sizeof(app->keywords) - 1);
+        } else if (strcmp(line, "NoDisplay=true") == 0 ||
+                   strcmp(line, "Hidden=true") == 0) {
+            hidden = true;
         }
     }
+    fclose(f);
+
+    return (hidden || !app->exec[0]) ? -1 : 0;
+}
+
+/* Re-scan the applications directory; caller holds apps mutex */
+static void app_index_rebuild(void) {
+    g_apps.count = 0;
+    g_apps.valid = true;
+    if (!g_apps.entries) return;
+
+    DIR *dir = opendir(APP_DIR);
+    if (!dir) return;
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL && g_apps.count < APP_MAX) {
+        if (!strstr(entry->d_name, ".desktop")) continue;
+        if (parse_desktop_file(entry->d_name, &g_apps.entries[g_apps.count]) == 0)
+            g_apps.count++;
+    }
     closedir(dir);
-    
+}
+
+static void app_index_init(void) {
+    g_apps.entries = calloc(APP_MAX, sizeof(app_entry_t));
+
+    g_apps.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (g_apps.inotify_fd >= 0) {
+        inotify_add_watch(g_apps.inotify_fd, APP_DIR,
+                          IN_CREATE | IN_DELETE | IN_MOVED_TO |
+                          IN_MOVED_FROM | IN_CLOSE_WRITE);
+    }
+
+    pthread_mutex_lock(&g_apps_mutex);
+    app_index_rebuild();
+    pthread_mutex_unlock(&g_apps_mutex);
+}
+
+/* Lock the index, rebuilding first if inotify saw changes */
+static void app_index_lock(void) {
+    pthread_once(&g_apps_once, app_index_init);
+    pthread_mutex_lock(&g_apps_mutex);
+
+    if (g_apps.inotify_fd >= 0) {
+        char buf[1024];
+        bool changed = false;
+        while (read(g_apps.inotify_fd, buf, sizeof(buf)) > 0)
+            changed = true;
+        if (changed) g_apps.valid = false;
+    }
+    if (!g_apps.valid) app_index_rebuild();
+}
+
+static void app_index_unlock(void) {
+    pthread_mutex_unlock(&g_apps_mutex);
+}
+
+/* Split an Exec line into argv in place, honoring double quotes */
+static int split_exec(char *exec, char **argv, int max_args) {
+    int argc = 0;
+    char *p = exec;
+    while (*p && argc < max_args - 1) {
+        while (*p == ' ') p++;
+        if (!*p) break;
+        if (*p == '"') {
+            argv[argc++] = ++p;
+            while (*p && *p != '"') p++;
+        } else {
+            argv[argc++] = p;
+            while (*p && *p != ' ') p++;
+        }
+        if (*p) *p++ = '\0';
+    }
+    argv[argc] = NULL;
+    return argc;
+}
+
+/* Double-fork and exec so the app is reparented instead of zombieing */
+static int spawn_argv(char **argv) {
+    pid_t pid = fork();
+    if (pid < 0) return -1;
+
+    if (pid == 0) {
+        if (fork() == 0) {
+            setsid();
+            int devnull = open("/dev/null", O_RDWR);
+            if (devnull >= 0) {
+                dup2(devnull, 0);
+                dup2(devnull, 1);
+                dup2(devnull, 2);
+                if (devnull > 2) close(devnull);
+            }
+            execvp(argv[0], argv);
+            _exit(127);
+        }
+        _exit(0);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    return 0;
+}
+
+int hal_app_launch(const char *name) {
+    if (!name) return -1;
+
+    app_index_lock();
+
+    /* Exact name or desktop-file match first, then substring/keywords */
+    const app_entry_t *best = NULL;
+    for (int i = 0; i < g_apps.count && !best; i++) {
+        if (strcasecmp(g_apps.entries[i].name, name) == 0 ||
+            strcasecmp(g_apps.entries[i].file, name) == 0)
+            best = &g_apps.entries[i];
+    }
+    for (int i = 0; i < g_apps.count && !best; i++) {
+        if (strcasestr(g_apps.entries[i].name, name) ||
+            strcasestr(g_apps.entries[i].keywords, name))
+            best = &g_apps.entries[i];
+    }
+
+    char exec[512];
+    if (best) memcpy(exec, best->exec, sizeof(exec));
+    app_index_unlock();
+
+    if (best) {
+        char *argv[32];
+        if (split_exec(exec, argv, 32) == 0) return -1;
+        return spawn_argv(argv);
+    }
+
+    /* Not in the index: try the name as a direct command */
+    char cmd[256];
+    strncpy(cmd, name, sizeof(cmd) - 1);
+    cmd[sizeof(cmd) - 1] = '\0';
+    char *argv[2] = { cmd, NULL };
+    return spawn_argv(argv);
+}
+
+int hal_app_list(char names[][256], int max_count) {
+    app_index_lock();
+
+    int count = (g_apps.count < max_count) ? g_apps.count : max_count;
+    for (int i = 0; i < count; i++) {
+        strncpy(names[i], g_apps.entries[i].file, 255);
+        names[i][255] = '\0';
+    }
+
+    app_index_unlock();
     return count;
 }
@@ -134,6 +134,20 @@ typedef struct {
  */
 int hal_system_info(system_info_t *info);
 
+/**
+ * Sample system info and publish it to the shared-memory metrics
+ * snapshot (one process should call this periodically, e.g. the agent)
+ * Returns 0 on success, -1 on error
+ */
+int hal_metrics_publish(void);
+
+/**
+ * Get system information from the shared-memory snapshot, lock-free
+ * and syscall-free; falls back to hal_system_info() when no publisher
+ * is running or the snapshot is stale
+ */
+int hal_system_info_cached(system_info_t *info);
+
 /* ==================== Applications ==================== */
 
 /**
@@ -26,6 +26,12 @@ static struct fb_var_screeninfo vinfo;
 static struct fb_fix_screeninfo finfo;
 static int screen_width, screen_height, bpp, line_length;
 
+/* Frames render into a malloc'd back buffer and fb_flip() copies only
+ * the dirty rectangle to the (uncached) framebuffer memory */
+static char *back_buf = NULL;
+static int dirty = 0;
+static int dirty_x0, dirty_y0, dirty_x1, dirty_y1;
+
 static int fb_init(void) {
     fb_fd = open(FB_DEVICE, O_RDWR);
     if (fb_fd < 0) {
@@ -56,12 +62,21 @@ static int fb_init(void) {
         close(fb_fd);
         return -1;
     }
-    
+
+    back_buf = malloc((size_t)screen_height * line_length);
+    if (!back_buf) {
+        munmap(fb_mem, finfo.smem_len);
+        close(fb_fd);
+        return -1;
+    }
+    memset(back_buf, 0, (size_t)screen_height * line_length);
+
     printf("[SPLASH] Framebuffer: %dx%d, %d bpp\n", screen_width, screen_height, bpp * 8);
     return 0;
 }
 
 static void fb_cleanup(void) {
+    free(back_buf);
     if (fb_mem && fb_mem != MAP_FAILED) {
         munmap(fb_mem, finfo.smem_len);
     }
@@ -70,21 +85,51 @@ static void fb_cleanup(void) {
     }
 }
 
+static void mark_dirty(int x, int y) {
+    if (!dirty) {
+        dirty_x0 = dirty_x1 = x;
+        dirty_y0 = dirty_y1 = y;
+        dirty = 1;
+        return;
+    }
+    if (x < dirty_x0) dirty_x0 = x;
+    if (x > dirty_x1) dirty_x1 = x;
+    if (y < dirty_y0) dirty_y0 = y;
+    if (y > dirty_y1) dirty_y1 = y;
+}
+
 static void put_pixel(int x, int y, unsigned int color) {
     if (x < 0 || x >= screen_width || y < 0 || y >= screen_height) return;
-    
+
     long offset = y * line_length + x * bpp;
-    
+
     if (bpp == 4) {
-        *((unsigned int *)(fb_mem + offset)) = color;
+        *((unsigned int *)(back_buf + offset)) = color;
     } else if (bpp == 3) {
-        fb_mem[offset] = color & 0xFF;
-        fb_mem[offset + 1] = (color >> 8) & 0xFF;
-        fb_mem[offset + 2] = (color >> 16) & 0xFF;
+        back_buf[offset] = color & 0xFF;
+        back_buf[offset + 1] = (color >> 8) & 0xFF;
+        back_buf[offset + 2] = (color >> 16) & 0xFF;
     } else if (bpp == 2) {
-        *((unsigned short *)(fb_mem + offset)) = 
+        *((unsigned short *)(back_buf + offset)) =
             ((color >> 8) & 0xF800) | ((color >> 5) & 0x07E0) | ((color >> 3) & 0x001F);
     }
+
+    mark_dirty(x, y);
+}
+
+/* Copy the dirty rectangle to the framebuffer, one memcpy per row */
+static void fb_flip(void) {
+    if (!dirty) return;
+
+    int x_bytes = dirty_x0 * bpp;
+    int w_bytes = (dirty_x1 - dirty_x0 + 1) * bpp;
+
+    for (int y = dirty_y0; y <= dirty_y1; y++) {
+        long offset = y * line_length + x_bytes;
+        memcpy(fb_mem + offset, back_buf + offset, w_bytes);
+    }
+
+    dirty = 0;
 }
 
 static void fill_rect(int x, int y, int w, int h, unsigned int color) {
@@ -99,13 +144,88 @@ static void fill_screen(unsigned int color) {
     fill_rect(0, 0, screen_width, screen_height, color);
 }
 
-static void draw_circle(int cx, int cy, int r, unsigned int color) {
-    for (int y = -r; y <= r; y++) {
-        for (int x = -r; x <= r; x++) {
-            if (x * x + y * y <= r * r) {
-                put_pixel(cx + x, cy + y, color);
+/* ==================== Rasterization Tables ==================== */
+
+/*
+ * Everything the animation draws is geometrically fixed, so the circle
+ * row spans, the outer-ring dot positions, and the glyph runs are built
+ * once at startup; drawing afterwards is pure blitting with no per-pixel
+ * distance tests and no trig.
+ */
+
+#define MAX_RADIUS 16
+#define RING_DOTS 72
+
+/* 5x7 font data for basic characters */
+static const unsigned char font_data[][7] = {
+    /* A */ {0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11},
+    /* I */ {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x1F},
+    /* - */ {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00},
+    /* O */ {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E},
+    /* S */ {0x0E, 0x11, 0x10, 0x0E, 0x01, 0x11, 0x0E},
+};
+
+/* Half-width of each circle row, indexed [radius][dy + radius] */
+static int g_circle_span[MAX_RADIUS + 1][2 * MAX_RADIUS + 1];
+
+/* Outer-ring dot offsets at scale 1.0 (one dot per 5 degrees) */
+static int g_ring_dx[RING_DOTS];
+static int g_ring_dy[RING_DOTS];
+
+/* Solid horizontal runs of each glyph */
+typedef struct {
+    unsigned char row;
+    unsigned char col;
+    unsigned char width;
+} glyph_span_t;
+
+static glyph_span_t g_glyph_spans[5][20];
+static int g_glyph_span_count[5];
+
+static void tables_init(void) {
+    for (int r = 0; r <= MAX_RADIUS; r++) {
+        for (int dy = -r; dy <= r; dy++) {
+            int w = 0;
+            while ((w + 1) * (w + 1) + dy * dy <= r * r) w++;
+            g_circle_span[r][dy + r] = w;
+        }
+    }
+
+    for (int i = 0; i < RING_DOTS; i++) {
+        float rad = (i * 5) * 3.14159f / 180.0f;
+        g_ring_dx[i] = (int)(80 * cos(rad));
+        g_ring_dy[i] = (int)(80 * sin(rad));
+    }
+
+    for (int c = 0; c < 5; c++) {
+        int n = 0;
+        for (int row = 0; row < 7; row++) {
+            unsigned char line = font_data[c][row];
+            int col = 0;
+            while (col < 5) {
+                if (!(line & (0x10 >> col))) {
+                    col++;
+                    continue;
+                }
+                int start = col;
+                while (col < 5 && (line & (0x10 >> col))) col++;
+                g_glyph_spans[c][n].row = row;
+                g_glyph_spans[c][n].col = start;
+                g_glyph_spans[c][n].width = col - start;
+                n++;
             }
         }
+        g_glyph_span_count[c] = n;
+    }
+}
+
+static void draw_circle(int cx, int cy, int r, unsigned int color) {
+    if (r > MAX_RADIUS) r = MAX_RADIUS;
+    for (int dy = -r; dy <= r; dy++) {
+        int w = g_circle_span[r][dy + r];
+        for (int x = cx - w; x <= cx + w; x++) {
+            put_pixel(x, cy + dy, color);
+        }
     }
 }
 
@@ -113,13 +233,10 @@ static void draw_circle(int cx, int cy, int r, unsigned int color) {
 
 /* Simple AI-OS logo: stylized brain/circuit pattern */
 static void draw_logo(int cx, int cy, float scale, unsigned int color) {
-    int size = (int)(80 * scale);
-    
-    /* Outer circle */
-    for (int a = 0; a < 360; a += 5) {
-        float rad = a * 3.14159 / 180;
-        int x = cx + (int)(size * cos(rad));
-        int y = cy + (int)(size * sin(rad));
+    /* Outer circle, from the precomputed dot ring */
+    for (int i = 0; i < RING_DOTS; i++) {
+        int x = cx + (int)(g_ring_dx[i] * scale);
+        int y = cy + (int)(g_ring_dy[i] * scale);
         draw_circle(x, y, 3, color);
     }
     
@@ -161,23 +278,11 @@ static void draw_logo(int cx, int cy, float scale, unsigned int color) {
 
 /* ==================== Text Drawing (Simple) ==================== */
 
-/* 5x7 font data for basic characters */
-static const unsigned char font_data[][7] = {
-    /* A */ {0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11},
-    /* I */ {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x1F},
-    /* - */ {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00},
-    /* O */ {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E},
-    /* S */ {0x0E, 0x11, 0x10, 0x0E, 0x01, 0x11, 0x0E},
-};
-
 static void draw_char(int x, int y, int ch_idx, int scale, unsigned int color) {
-    for (int row = 0; row < 7; row++) {
-        unsigned char line = font_data[ch_idx][row];
-        for (int col = 0; col < 5; col++) {
-            if (line & (0x10 >> col)) {
-                fill_rect(x + col * scale, y + row * scale, scale, scale, color);
-            }
-        }
+    for (int i = 0; i < g_glyph_span_count[ch_idx]; i++) {
+        const glyph_span_t *s = &g_glyph_spans[ch_idx][i];
+        fill_rect(x + s->col * scale, y + s->row * scale,
+                  s->width * scale, scale, color);
     }
 }
 
@@ -225,14 +330,23 @@ static void run_animation(void) {
     
     /* Bar background */
     fill_rect(bar_x - 2, bar_y - 2, bar_width + 4, bar_height + 4, 0xFF333355);
-    
-    /* Animate progress */
+
+    /* One full-screen copy for the static scene */
+    fb_flip();
+
+    /* Animate progress; only the grown bar segment is copied per frame */
+    int last_filled = 0;
     for (int progress = 0; progress <= 100 && g_running; progress += 2) {
         int filled = (bar_width * progress) / 100;
-        fill_rect(bar_x, bar_y, filled, bar_height, logo_color);
+        if (filled > last_filled) {
+            fill_rect(bar_x + last_filled, bar_y, filled - last_filled,
+                      bar_height, logo_color);
+            last_filled = filled;
+            fb_flip();
+        }
         usleep(50000);  /* 50ms */
     }
-    
+
     /* Hold for a moment */
     sleep(1);
 }
@@ -249,7 +363,8 @@ int main(int argc, char *argv[]) {
         fprintf(stderr, "Framebuffer not available, skipping splash\n");
         return 0;
     }
-    
+
+    tables_init();
     run_animation();
     
     fb_cleanup();
@@ -0,0 +1,312 @@
+/**
+ * AI-OS IPC Client Library Implementation
+ * One connection per daemon, kept open across requests: connect latency
+ * is paid once instead of per message, and a dead socket (daemon
+ * restart) is reconnected transparently on the next request.
+ *
+ * Compile: gcc -o libaios-ipc.so -shared -fPIC ipc.c
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+#include "ipc.h"
+
+/* ==================== Connection Management ==================== */
+
+void aios_ipc_init(aios_ipc_t *conn, const char *socket_path) {
+    conn->fd = -1;
+    strncpy(conn->path, socket_path, sizeof(conn->path) - 1);
+    conn->path[sizeof(conn->path) - 1] = '\0';
+}
+
+void aios_ipc_close(aios_ipc_t *conn) {
+    if (conn->fd >= 0) close(conn->fd);
+    conn->fd = -1;
+}
+
+static int ipc_connect(aios_ipc_t *conn) {
+    if (conn->fd >= 0) return 0;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, conn->path, sizeof(addr.sun_path) - 1);
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    conn->fd = fd;
+    return 0;
+}
+
+int aios_ipc_connect(aios_ipc_t *conn) {
+    if (ipc_connect(conn) < 0) return -1;
+    return conn->fd;
+}
+
+/* ==================== Framing ==================== */
+
+int aios_ipc_send_frame(int fd, const char *msg, size_t len) {
+    /* Header and payload go out in one scatter-gather syscall */
+    uint32_t netlen = htonl((uint32_t)len);
+    struct iovec iov[2] = {
+        { .iov_base = &netlen, .iov_len = 4 },
+        { .iov_base = (void *)msg, .iov_len = len }
+    };
+    struct msghdr mh = { .msg_iov = iov, .msg_iovlen = 2 };
+
+    size_t total = 4 + len;
+    while (total > 0) {
+        ssize_t n = sendmsg(fd, &mh, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        total -= (size_t)n;
+
+        /* Advance past whatever went out (short writes are rare) */
+        while (n > 0 && mh.msg_iovlen > 0) {
+            struct iovec *v = mh.msg_iov;
+            if ((size_t)n >= v->iov_len) {
+                n -= v->iov_len;
+                mh.msg_iov++;
+                mh.msg_iovlen--;
+            } else {
+                v->iov_base = (char *)v->iov_base + n;
+                v->iov_len -= (size_t)n;
+                n = 0;
+            }
+        }
+    }
+    return 0;
+}
+
+int aios_ipc_recv_frame(int fd, char *buf, size_t buf_size) {
+    uint32_t len;
+    size_t got = 0;
+    while (got < 4) {
+        ssize_t n = recv(fd, (char *)&len + got, 4 - got, 0);
+        if (n <= 0) return -1;
+        got += n;
+    }
+    len = ntohl(len);
+
+    size_t want = len;
+    if (want >= buf_size) want = buf_size - 1;
+
+    size_t received = 0;
+    while (received < want) {
+        ssize_t n = recv(fd, buf + received, want - received, 0);
+        if (n <= 0) return -1;
+        received += n;
+    }
+    buf[received] = '\0';
+
+    /* Drain anything that didn't fit so the stream stays framed */
+    while (received < len) {
+        char skip[1024];
+        size_t chunk = len - received;
+        if (chunk > sizeof(skip)) chunk = sizeof(skip);
+        ssize_t n = recv(fd, skip, chunk, 0);
+        if (n <= 0) return -1;
+        received += (size_t)n;
+    }
+    return 0;
+}
+
+/* ==================== Requests ==================== */
+
+int aios_ipc_request_stream(aios_ipc_t *conn, const char *msg,
+                            char *response, size_t response_size,
+                            aios_ipc_stream_cb cb, void *userdata) {
+    size_t len = strlen(msg);
+
+    /* Retry once with a fresh connection: the daemon may have restarted
+     * or closed an idle socket since the last request */
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (ipc_connect(conn) < 0) {
+            return -1;
+        }
+
+        if (aios_ipc_send_frame(conn->fd, msg, len) < 0 ||
+            aios_ipc_recv_frame(conn->fd, response, response_size) < 0) {
+            aios_ipc_close(conn);
+            continue;
+        }
+
+        int deltas = 0;
+        for (;;) {
+            if (!strstr(response, "\"status\":\"partial\"")) {
+                return deltas;      /* final frame stays in response */
+            }
+
+            char *p = strstr(response, "\"delta\":\"");
+            if (p) {
+                p += 9;
+                char *end = strchr(p, '"');
+                if (end) {
+                    *end = '\0';
+                    if (cb) cb(p, userdata);
+                    deltas++;
+                }
+            }
+
+            /* Mid-stream failures are not retryable */
+            if (aios_ipc_recv_frame(conn->fd, response, response_size) < 0) {
+                aios_ipc_close(conn);
+                return -1;
+            }
+        }
+    }
+
+    return -1;
+}
+
+int aios_ipc_request(aios_ipc_t *conn, const char *msg,
+                     char *response, size_t response_size) {
+    int r = aios_ipc_request_stream(conn, msg, response, response_size,
+                                    NULL, NULL);
+    return (r < 0) ? -1 : 0;
+}
+
+/* ==================== Server Side ==================== */
+
+struct ipc_client {
+    int fd;
+    const aios_ipc_server_t *srv;
+};
+
+static void *ipc_client_thread(void *arg) {
+    struct ipc_client *ctx = arg;
+    int fd = ctx->fd;
+    const aios_ipc_server_t *srv = ctx->srv;
+    free(ctx);
+
+    /* One receive and one response buffer for the connection's
+     * lifetime, reused for every frame instead of malloc per message */
+    char *msg = malloc(AIOS_IPC_MAX_MSG);
+    char *response = malloc(AIOS_IPC_MAX_MSG);
+
+    while (msg && response &&
+           aios_ipc_recv_frame(fd, msg, AIOS_IPC_MAX_MSG) == 0) {
+        strcpy(response, "{\"status\":\"ok\"}");
+
+        char cmd[64] = "";
+        char *p = strstr(msg, "\"cmd\":\"");
+        if (p) sscanf(p + 7, "%63[^\"]", cmd);
+
+        uint64_t start = aios_stats_now_us();
+        const aios_ipc_cmd_t *match = NULL;
+
+        for (const aios_ipc_cmd_t *c = srv->cmds; c->cmd; c++) {
+            if (strcmp(c->cmd, cmd) == 0) {
+                match = c;
+                c->fn(fd, msg, response, AIOS_IPC_MAX_MSG);
+                break;
+            }
+        }
+
+        size_t resp_len = strlen(response);
+        if (aios_ipc_send_frame(fd, response, resp_len) < 0) break;
+
+        /* Ops were registered at init, so this only ever finds */
+        if (match && srv->stats) {
+            aios_stats_record(aios_stats_register(srv->stats, match->cmd),
+                              start, strlen(msg), resp_len);
+        }
+    }
+
+    free(msg);
+    free(response);
+    if (srv->on_disconnect) srv->on_disconnect(fd);
+    close(fd);
+    return NULL;
+}
+
+int aios_ipc_server_init(aios_ipc_server_t *srv, const char *socket_path,
+                         const aios_ipc_cmd_t *cmds) {
+    srv->cmds = cmds;
+    srv->on_disconnect = NULL;
+    strncpy(srv->path, socket_path, sizeof(srv->path) - 1);
+    srv->path[sizeof(srv->path) - 1] = '\0';
+
+    srv->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (srv->fd < 0) return -1;
+
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, srv->path, sizeof(addr.sun_path) - 1);
+
+    unlink(srv->path);
+
+    if (bind(srv->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(srv->fd);
+        srv->fd = -1;
+        return -1;
+    }
+
+    chmod(srv->path, 0666);
+    listen(srv->fd, 16);
+
+    /* Per-command latency/byte counters, named after the socket
+     * (/run/aios/power.sock -> /dev/shm/aios-stats-power) */
+    char name[32];
+    const char *base = strrchr(srv->path, '/');
+    snprintf(name, sizeof(name), "%s", base ? base + 1 : srv->path);
+    char *dot = strrchr(name, '.');
+    if (dot) *dot = '\0';
+
+    srv->stats = aios_stats_open(name);
+    for (const aios_ipc_cmd_t *c = cmds; c->cmd; c++) {
+        aios_stats_register(srv->stats, c->cmd);
+    }
+    return 0;
+}
+
+int aios_ipc_server_run(aios_ipc_server_t *srv, volatile int *running) {
+    while (*running) {
+        int client = accept(srv->fd, NULL, NULL);
+        if (client < 0) continue;
+
+        struct ipc_client *ctx = malloc(sizeof(*ctx));
+        if (!ctx) {
+            close(client);
+            continue;
+        }
+        ctx->fd = client;
+        ctx->srv = srv;
+
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, ipc_client_thread, ctx) != 0) {
+            close(client);
+            free(ctx);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+    return 0;
+}
+
+void aios_ipc_server_close(aios_ipc_server_t *srv) {
+    if (srv->fd >= 0) {
+        close(srv->fd);
+        unlink(srv->path);
+        srv->fd = -1;
+    }
+}
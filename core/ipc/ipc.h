@@ -0,0 +1,101 @@
+/**
+ * AI-OS IPC Client Library
+ * Persistent, auto-reconnecting connections to AI-OS daemons using the
+ * shared 4-byte length framing.
+ *
+ * Compile: gcc -o libaios-ipc.so -shared -fPIC ipc.c
+ */
+
+#ifndef AIOS_IPC_H
+#define AIOS_IPC_H
+
+#include <stddef.h>
+
+#include "stats.h"
+
+/* Persistent connection handle; fd is -1 while disconnected */
+typedef struct {
+    int fd;
+    char path[108];
+} aios_ipc_t;
+
+/* Partial-frame callback for streamed responses (raw delta text) */
+typedef void (*aios_ipc_stream_cb)(const char *delta, void *userdata);
+
+/* Prepare a handle; no connection is made until the first request */
+void aios_ipc_init(aios_ipc_t *conn, const char *socket_path);
+
+/* Drop the connection (the next request reconnects) */
+void aios_ipc_close(aios_ipc_t *conn);
+
+/**
+ * Ensure the connection is open, for callers doing their own framing
+ * (e.g. pipelined batches)
+ * Returns the socket fd, or -1 on error
+ */
+int aios_ipc_connect(aios_ipc_t *conn);
+
+/**
+ * Framed send/recv on a raw fd, shared by clients and daemons
+ * Return 0 on success, -1 on error
+ */
+int aios_ipc_send_frame(int fd, const char *msg, size_t len);
+int aios_ipc_recv_frame(int fd, char *buf, size_t buf_size);
+
+/**
+ * One request/response round-trip on the persistent connection;
+ * reconnects and retries once if the socket went stale
+ * Returns 0 on success, -1 on error
+ */
+int aios_ipc_request(aios_ipc_t *conn, const char *msg,
+                     char *response, size_t response_size);
+
+/**
+ * Like aios_ipc_request, but invokes cb for every partial frame; the
+ * final frame is left in response
+ * Returns the number of deltas delivered, or -1 on error
+ */
+int aios_ipc_request_stream(aios_ipc_t *conn, const char *msg,
+                            char *response, size_t response_size,
+                            aios_ipc_stream_cb cb, void *userdata);
+
+/* ==================== Server Side ==================== */
+
+/* Per-connection receive/response buffer size */
+#define AIOS_IPC_MAX_MSG 8192
+
+/**
+ * Command handler: invoked with the raw request when its "cmd" value
+ * matches; fills response (pre-set to {"status":"ok"}) with the reply
+ */
+typedef void (*aios_ipc_handler_fn)(int client_fd, const char *msg,
+                                    char *response, size_t response_size);
+
+typedef struct {
+    const char *cmd;            /* value matched against "cmd":"..." */
+    aios_ipc_handler_fn fn;
+} aios_ipc_cmd_t;
+
+typedef struct {
+    int fd;                     /* listening socket */
+    char path[108];
+    const aios_ipc_cmd_t *cmds; /* table terminated by {NULL, NULL} */
+    void (*on_disconnect)(int client_fd);   /* optional, may be NULL */
+    aios_stats_page_t *stats;   /* per-command counters, may be NULL */
+} aios_ipc_server_t;
+
+/**
+ * Bind the daemon socket (unlinking any stale one) and store the
+ * handler table
+ * Returns 0 on success, -1 on error
+ */
+int aios_ipc_server_init(aios_ipc_server_t *srv, const char *socket_path,
+                         const aios_ipc_cmd_t *cmds);
+
+/* Accept loop, one detached thread per client with preallocated
+ * buffers; returns once *running drops to 0 */
+int aios_ipc_server_run(aios_ipc_server_t *srv, volatile int *running);
+
+void aios_ipc_server_close(aios_ipc_server_t *srv);
+
+#endif /* AIOS_IPC_H */
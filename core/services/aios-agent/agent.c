@@ -9,30 +9,41 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <signal.h>
 #include <pthread.h>
+#include <arpa/inet.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <poll.h>
 #include <time.h>
 #include <curl/curl.h>
 #include <cjson/cJSON.h>
 
 #include "agent.h"
 #include "hal.h"
+#include "stats.h"
 
 /* ==================== Globals ==================== */
 
 static agent_config_t g_config;
 static int g_server_fd = -1;
 static volatile bool g_running = false;
-static chat_message_t g_history[MAX_HISTORY_SIZE];
 static int g_history_count = 0;
 static pthread_mutex_t g_history_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/* Hot-path counters, dumped by `aios stats` */
+static aios_stats_page_t *g_stats;
+static aios_stats_op_t *g_stat_chat;    /* agent_chat end-to-end */
+static aios_stats_op_t *g_stat_llm;     /* provider round-trip */
+static aios_stats_op_t *g_stat_action;  /* action dispatch */
+
 /* ==================== Logging ==================== */
 
 static FILE *g_log_file = NULL;
@@ -128,71 +139,634 @@ static int load_config(void) {
     return 0;
 }
 
+/* ==================== Per-Request Arena ==================== */
+
+/*
+ * Bump allocator backing the IPC hot path. Each connection owns an arena
+ * that is reset (not freed) after every reply, so the per-request cJSON
+ * parse tree, response tree, and printed strings cost a pointer bump
+ * instead of individual malloc/free pairs. The largest block is retained
+ * across requests; additional blocks grow geometrically.
+ */
+
+#define ARENA_BLOCK_MIN (16 * 1024)
+
+typedef struct arena_block {
+    struct arena_block *next;
+    size_t cap;
+    size_t used;
+    /* data follows */
+} arena_block_t;
+
+typedef struct {
+    arena_block_t *head;
+} arena_t;
+
+static void *arena_alloc(arena_t *a, size_t size) {
+    size = (size + 15) & ~(size_t)15;
+
+    arena_block_t *blk = a->head;
+    if (!blk || blk->used + size > blk->cap) {
+        size_t cap = blk ? blk->cap * 2 : ARENA_BLOCK_MIN;
+        if (cap < size) cap = size;
+
+        arena_block_t *nb = malloc(sizeof(arena_block_t) + cap);
+        if (!nb) return NULL;
+        nb->cap = cap;
+        nb->used = 0;
+        nb->next = blk;
+        a->head = nb;
+        blk = nb;
+    }
+
+    void *ptr = (char *)(blk + 1) + blk->used;
+    blk->used += size;
+    return ptr;
+}
+
+/* Keep the newest (largest) block, release the rest */
+static void arena_reset(arena_t *a) {
+    if (!a->head) return;
+
+    arena_block_t *blk = a->head->next;
+    while (blk) {
+        arena_block_t *next = blk->next;
+        free(blk);
+        blk = next;
+    }
+    a->head->next = NULL;
+    a->head->used = 0;
+}
+
+static void arena_destroy(arena_t *a) {
+    arena_block_t *blk = a->head;
+    while (blk) {
+        arena_block_t *next = blk->next;
+        free(blk);
+        blk = next;
+    }
+    a->head = NULL;
+}
+
+/*
+ * cJSON allocation hooks. Workers point t_arena at their connection's
+ * arena for the duration of a request; everything cJSON allocates then
+ * comes from the arena and is reclaimed wholesale on reset. Allocations
+ * made outside a request context (config load, SSE parsing on the curl
+ * I/O thread) fall through to the heap. Every allocation carries a tag
+ * header so the free hook can tell the two apart.
+ */
+
+#define JSON_ALLOC_ARENA 0xA17E4AULL
+#define JSON_ALLOC_HEAP  0x4EA900ULL
+
+static __thread arena_t *t_arena = NULL;
+
+static void *json_malloc_hook(size_t size) {
+    uint64_t *p;
+    if (t_arena) {
+        p = arena_alloc(t_arena, size + 16);
+        if (!p) return NULL;
+        p[0] = JSON_ALLOC_ARENA;
+    } else {
+        p = malloc(size + 16);
+        if (!p) return NULL;
+        p[0] = JSON_ALLOC_HEAP;
+    }
+    return p + 2;
+}
+
+static void json_free_hook(void *ptr) {
+    if (!ptr) return;
+    uint64_t *p = (uint64_t *)ptr - 2;
+    if (p[0] == JSON_ALLOC_HEAP) {
+        free(p);
+    }
+    /* Arena allocations are reclaimed wholesale on arena_reset() */
+}
+
 /* ==================== HTTP Helper ==================== */
 
 struct response_buffer {
     char *data;
     size_t size;
+    size_t cap;
 };
 
 static size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
     size_t total = size * nmemb;
     struct response_buffer *buf = (struct response_buffer *)userp;
-    
-    char *ptr = realloc(buf->data, buf->size + total + 1);
-    if (!ptr) return 0;
-    
-    buf->data = ptr;
+
+    /* Grow geometrically instead of realloc'ing per network chunk */
+    if (buf->size + total + 1 > buf->cap) {
+        size_t cap = buf->cap ? buf->cap * 2 : 4096;
+        while (cap < buf->size + total + 1) cap *= 2;
+        char *ptr = realloc(buf->data, cap);
+        if (!ptr) return 0;
+        buf->data = ptr;
+        buf->cap = cap;
+    }
+
     memcpy(&buf->data[buf->size], contents, total);
     buf->size += total;
     buf->data[buf->size] = '\0';
-    
+
     return total;
 }
 
-/* ==================== AI Integration ==================== */
+/* ==================== Async LLM Client ==================== */
+
+/*
+ * All provider HTTP traffic goes through one curl_multi handle driven by a
+ * dedicated I/O thread. The multi handle owns the connection cache, so
+ * consecutive chats reuse the established TLS connection (keep-alive and
+ * HTTP/2 multiplexing) instead of paying a fresh handshake per request,
+ * and concurrent in-flight requests no longer serialize behind each other.
+ */
+
+typedef struct llm_request {
+    CURL *easy;
+    CURLcode result;
+    bool done;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    struct llm_request *next;
+} llm_request_t;
+
+static CURLM *g_curl_multi = NULL;
+static pthread_t g_llm_thread;
+static volatile bool g_llm_running = false;
+static llm_request_t *g_llm_pending = NULL;
+static pthread_mutex_t g_llm_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void *llm_thread_main(void *arg) {
+    (void)arg;
+
+    while (g_llm_running) {
+        /* Pick up newly submitted requests */
+        pthread_mutex_lock(&g_llm_mutex);
+        llm_request_t *req = g_llm_pending;
+        g_llm_pending = NULL;
+        pthread_mutex_unlock(&g_llm_mutex);
+
+        while (req) {
+            llm_request_t *next = req->next;
+            curl_multi_add_handle(g_curl_multi, req->easy);
+            req = next;
+        }
+
+        int running = 0;
+        curl_multi_perform(g_curl_multi, &running);
+
+        /* Complete finished transfers */
+        CURLMsg *msg;
+        int left;
+        while ((msg = curl_multi_info_read(g_curl_multi, &left))) {
+            if (msg->msg != CURLMSG_DONE) continue;
+
+            llm_request_t *done_req = NULL;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &done_req);
+            curl_multi_remove_handle(g_curl_multi, msg->easy_handle);
+
+            if (done_req) {
+                pthread_mutex_lock(&done_req->mutex);
+                done_req->result = msg->data.result;
+                done_req->done = true;
+                pthread_cond_signal(&done_req->cond);
+                pthread_mutex_unlock(&done_req->mutex);
+            }
+        }
+
+        /* Sleep until socket activity or a curl_multi_wakeup() from a submitter */
+        curl_multi_poll(g_curl_multi, NULL, 0, 1000, NULL);
+    }
+
+    return NULL;
+}
+
+/*
+ * Perform one HTTP POST through the shared multi handle.
+ * Blocks the calling worker until the transfer completes, but transfers
+ * from other workers proceed concurrently on the I/O thread.
+ */
+static CURLcode llm_perform(const char *url, struct curl_slist *headers,
+                            const char *post_data,
+                            size_t (*write_fn)(void *, size_t, size_t, void *),
+                            void *write_userdata) {
+    if (!g_llm_running) return CURLE_FAILED_INIT;
+
+    llm_request_t req;
+    memset(&req, 0, sizeof(req));
+    req.done = false;
+    req.result = CURLE_OK;
+    pthread_mutex_init(&req.mutex, NULL);
+    pthread_cond_init(&req.cond, NULL);
+
+    req.easy = curl_easy_init();
+    if (!req.easy) {
+        pthread_mutex_destroy(&req.mutex);
+        pthread_cond_destroy(&req.cond);
+        return CURLE_FAILED_INIT;
+    }
+
+    curl_easy_setopt(req.easy, CURLOPT_URL, url);
+    curl_easy_setopt(req.easy, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(req.easy, CURLOPT_POSTFIELDS, post_data);
+    curl_easy_setopt(req.easy, CURLOPT_WRITEFUNCTION, write_fn);
+    curl_easy_setopt(req.easy, CURLOPT_WRITEDATA, write_userdata);
+    curl_easy_setopt(req.easy, CURLOPT_TIMEOUT, 30L);
+    curl_easy_setopt(req.easy, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(req.easy, CURLOPT_PIPEWAIT, 1L);
+    curl_easy_setopt(req.easy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(req.easy, CURLOPT_PRIVATE, &req);
+
+    /* Submit to the I/O thread */
+    pthread_mutex_lock(&g_llm_mutex);
+    req.next = g_llm_pending;
+    g_llm_pending = &req;
+    pthread_mutex_unlock(&g_llm_mutex);
+    curl_multi_wakeup(g_curl_multi);
+
+    /* Wait for completion */
+    pthread_mutex_lock(&req.mutex);
+    while (!req.done) {
+        pthread_cond_wait(&req.cond, &req.mutex);
+    }
+    pthread_mutex_unlock(&req.mutex);
+
+    /* The easy handle is already detached from the multi handle; dropping it
+     * returns its connection to the shared cache. */
+    curl_easy_cleanup(req.easy);
+    pthread_mutex_destroy(&req.mutex);
+    pthread_cond_destroy(&req.cond);
+
+    return req.result;
+}
+
+static int llm_client_init(void) {
+    g_curl_multi = curl_multi_init();
+    if (!g_curl_multi) return -1;
+
+    curl_multi_setopt(g_curl_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(g_curl_multi, CURLMOPT_MAX_HOST_CONNECTIONS, 4L);
+
+    g_llm_running = true;
+    if (pthread_create(&g_llm_thread, NULL, llm_thread_main, NULL) != 0) {
+        g_llm_running = false;
+        curl_multi_cleanup(g_curl_multi);
+        g_curl_multi = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+static void llm_client_cleanup(void) {
+    if (!g_llm_running) return;
+
+    g_llm_running = false;
+    curl_multi_wakeup(g_curl_multi);
+    pthread_join(g_llm_thread, NULL);
+    curl_multi_cleanup(g_curl_multi);
+    g_curl_multi = NULL;
+}
+
+/* ==================== Incremental History Serialization ==================== */
+
+/*
+ * The chat history is kept pre-serialized as an append-only byte buffer of
+ * ",{\"role\":...,\"content\":...}" segments (leading comma per segment), kept
+ * in lockstep with the persistent ring under g_history_mutex. Building a
+ * request splices this buffer between a constant prefix and the new user
+ * turn, so request-build cost is O(new message) instead of re-serializing
+ * the whole history every chat.
+ */
+
+static char *g_history_json = NULL;
+static size_t g_history_json_len = 0;
+static size_t g_history_json_cap = 0;
+static size_t g_history_offsets[MAX_HISTORY_SIZE];
+
+/* System prompt pre-serialized as a message object */
+static const char SYSTEM_MSG_JSON[] =
+    "{\"role\":\"system\",\"content\":\"You are AI-OS, an AI assistant integrated "
+    "into the operating system. You can control hardware and system settings. "
+    "When you need to perform an action, respond with JSON: "
+    "{\\\"action\\\": \\\"name\\\", \\\"param\\\": value}. "
+    "Actions: brightness, volume, mute, wifi, bluetooth, shutdown, reboot, "
+    "suspend, launch, info\"}";
+
+/* Serialize one message into a malloc'd ",{...}" segment */
+static char *serialize_message(const char *role, const char *content, size_t *seg_len) {
+    cJSON *msg = cJSON_CreateObject();
+    cJSON_AddStringToObject(msg, "role", role);
+    cJSON_AddStringToObject(msg, "content", content);
+
+    char *json = cJSON_PrintUnformatted(msg);
+    cJSON_Delete(msg);
+    if (!json) return NULL;
+
+    size_t json_len = strlen(json);
+    char *seg = malloc(json_len + 2);
+    if (!seg) {
+        cJSON_free(json);
+        return NULL;
+    }
+    seg[0] = ',';
+    memcpy(seg + 1, json, json_len + 1);
+    cJSON_free(json);
+
+    *seg_len = json_len + 1;
+    return seg;
+}
+
+/* Append one message segment; caller holds g_history_mutex */
+static int history_json_append(const char *role, const char *content) {
+    size_t seg_len;
+    char *seg = serialize_message(role, content, &seg_len);
+    if (!seg) return -1;
+
+    if (g_history_json_len + seg_len + 1 > g_history_json_cap) {
+        size_t cap = g_history_json_cap ? g_history_json_cap : 4096;
+        while (cap < g_history_json_len + seg_len + 1) cap *= 2;
+        char *buf = realloc(g_history_json, cap);
+        if (!buf) {
+            free(seg);
+            return -1;
+        }
+        g_history_json = buf;
+        g_history_json_cap = cap;
+    }
+
+    g_history_offsets[g_history_count] = g_history_json_len;
+    memcpy(g_history_json + g_history_json_len, seg, seg_len + 1);
+    g_history_json_len += seg_len;
+    free(seg);
+    return 0;
+}
+
+/* Drop the oldest segment; caller holds g_history_mutex */
+static void history_json_evict_oldest(void) {
+    if (g_history_count == 0 || g_history_json_len == 0) return;
+
+    size_t seg_len = (g_history_count > 1) ? g_history_offsets[1] : g_history_json_len;
+    memmove(g_history_json, g_history_json + seg_len, g_history_json_len - seg_len + 1);
+    g_history_json_len -= seg_len;
+
+    for (int i = 1; i < g_history_count; i++) {
+        g_history_offsets[i - 1] = g_history_offsets[i] - seg_len;
+    }
+}
+
+/*
+ * Assemble the full provider request body by splicing the pre-serialized
+ * history between a fixed prefix and the new user turn.
+ */
+static char *build_chat_request(const char *user_message, bool stream) {
+    size_t user_len;
+    char *user_seg = serialize_message("user", user_message, &user_len);
+    if (!user_seg) return NULL;
+
+    char prefix[128];
+    int prefix_len = snprintf(prefix, sizeof(prefix),
+        "{\"model\":\"%s\",\"messages\":[", g_config.model);
+
+    const char *suffix = stream
+        ? "],\"max_tokens\":1024,\"stream\":true}"
+        : "],\"max_tokens\":1024}";
+    size_t suffix_len = strlen(suffix);
 
-static int call_openai(const char *user_message, char *response, size_t response_size) {
-    CURL *curl = curl_easy_init();
-    if (!curl) return -1;
-    
-    /* Build request */
-    cJSON *root = cJSON_CreateObject();
-    cJSON_AddStringToObject(root, "model", g_config.model);
-    
-    cJSON *messages = cJSON_CreateArray();
-    
-    /* System prompt */
-    cJSON *sys_msg = cJSON_CreateObject();
-    cJSON_AddStringToObject(sys_msg, "role", "system");
-    cJSON_AddStringToObject(sys_msg, "content", 
-        "You are AI-OS, an AI assistant integrated into the operating system. "
-        "You can control hardware and system settings. When you need to perform an action, "
-        "respond with JSON: {\"action\": \"name\", \"param\": value}. "
-        "Actions: brightness, volume, mute, wifi, bluetooth, shutdown, reboot, suspend, launch, info");
-    cJSON_AddItemToArray(messages, sys_msg);
-    
-    /* History */
     pthread_mutex_lock(&g_history_mutex);
-    for (int i = 0; i < g_history_count; i++) {
-        cJSON *msg = cJSON_CreateObject();
-        cJSON_AddStringToObject(msg, "role", g_history[i].role);
-        cJSON_AddStringToObject(msg, "content", g_history[i].content);
-        cJSON_AddItemToArray(messages, msg);
+    size_t total = prefix_len + (sizeof(SYSTEM_MSG_JSON) - 1) +
+                   g_history_json_len + user_len + suffix_len + 1;
+
+    char *buf = malloc(total);
+    if (buf) {
+        char *p = buf;
+        memcpy(p, prefix, prefix_len);                          p += prefix_len;
+        memcpy(p, SYSTEM_MSG_JSON, sizeof(SYSTEM_MSG_JSON) - 1); p += sizeof(SYSTEM_MSG_JSON) - 1;
+        memcpy(p, g_history_json, g_history_json_len);          p += g_history_json_len;
+        memcpy(p, user_seg, user_len);                          p += user_len;
+        memcpy(p, suffix, suffix_len + 1);
     }
     pthread_mutex_unlock(&g_history_mutex);
-    
-    /* User message */
-    cJSON *user_msg = cJSON_CreateObject();
-    cJSON_AddStringToObject(user_msg, "role", "user");
-    cJSON_AddStringToObject(user_msg, "content", user_message);
-    cJSON_AddItemToArray(messages, user_msg);
-    
-    cJSON_AddItemToObject(root, "messages", messages);
-    cJSON_AddNumberToObject(root, "max_tokens", 1024);
-    
-    char *post_data = cJSON_PrintUnformatted(root);
-    cJSON_Delete(root);
+
+    free(user_seg);
+    return buf;
+}
+
+/* ==================== Persistent Conversation Ring ==================== */
+
+/*
+ * Chat history lives in a fixed ring of records inside a file mapped with
+ * MAP_SHARED, so appending is an O(1) in-place store (no memmove shifting,
+ * no per-message heap churn) and the conversation survives a daemon
+ * restart. The header tracks head/count; eviction just advances head.
+ * Dirty pages are flushed with msync(MS_ASYNC) so writeback never blocks
+ * the chat path.
+ */
+
+#define HISTORY_RING_PATH    "/var/lib/aios/history.ring"
+#define HISTORY_RING_MAGIC   0x41494831  /* "AIH1" */
+#define HISTORY_RING_VERSION 1
+#define HISTORY_CONTENT_MAX  4096
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t head;      /* index of the oldest record */
+    uint32_t count;     /* number of valid records */
+} history_ring_header_t;
+
+typedef struct {
+    char role[16];
+    uint32_t len;
+    char content[HISTORY_CONTENT_MAX];
+} history_record_t;
+
+static history_ring_header_t *g_ring_hdr = NULL;
+static history_record_t *g_ring_recs = NULL;
+static size_t g_ring_map_len = 0;
+
+/* Map the ring file, initializing or validating it, then warm-load history */
+static int history_ring_open(void) {
+    g_ring_map_len = sizeof(history_ring_header_t) +
+                     sizeof(history_record_t) * MAX_HISTORY_SIZE;
+
+    int fd = open(HISTORY_RING_PATH, O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+        LOG_WARN("Cannot open %s: %s", HISTORY_RING_PATH, strerror(errno));
+        return -1;
+    }
+
+    struct stat st;
+    bool fresh = (fstat(fd, &st) != 0 || st.st_size < (off_t)g_ring_map_len);
+    if (ftruncate(fd, g_ring_map_len) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, g_ring_map_len, PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        LOG_WARN("Cannot map history ring: %s", strerror(errno));
+        return -1;
+    }
+
+    g_ring_hdr = (history_ring_header_t *)map;
+    g_ring_recs = (history_record_t *)((char *)map + sizeof(history_ring_header_t));
+
+    if (fresh || g_ring_hdr->magic != HISTORY_RING_MAGIC ||
+        g_ring_hdr->version != HISTORY_RING_VERSION ||
+        g_ring_hdr->head >= MAX_HISTORY_SIZE ||
+        g_ring_hdr->count > MAX_HISTORY_SIZE) {
+        memset(map, 0, g_ring_map_len);
+        g_ring_hdr->magic = HISTORY_RING_MAGIC;
+        g_ring_hdr->version = HISTORY_RING_VERSION;
+        msync(map, g_ring_map_len, MS_ASYNC);
+        return 0;
+    }
+
+    /* Warm start: rebuild the serialized buffer from surviving records */
+    for (uint32_t i = 0; i < g_ring_hdr->count; i++) {
+        history_record_t *rec = &g_ring_recs[(g_ring_hdr->head + i) % MAX_HISTORY_SIZE];
+        rec->role[sizeof(rec->role) - 1] = '\0';
+        rec->content[HISTORY_CONTENT_MAX - 1] = '\0';
+        if (history_json_append(rec->role, rec->content) == 0) {
+            g_history_count++;
+        }
+    }
+    if (g_history_count > 0) {
+        LOG_INFO("Restored %d history messages from %s",
+                 g_history_count, HISTORY_RING_PATH);
+    }
+    return 0;
+}
+
+/* Append one message to the ring and serialized buffer; caller holds mutex */
+static void history_append(const char *role, const char *content) {
+    if (g_history_count >= MAX_HISTORY_SIZE) {
+        history_json_evict_oldest();
+        g_history_count--;
+        if (g_ring_hdr && g_ring_hdr->count > 0) {
+            g_ring_hdr->head = (g_ring_hdr->head + 1) % MAX_HISTORY_SIZE;
+            g_ring_hdr->count--;
+        }
+    }
+
+    if (history_json_append(role, content) != 0) return;
+    g_history_count++;
+
+    if (g_ring_hdr) {
+        uint32_t idx = (g_ring_hdr->head + g_ring_hdr->count) % MAX_HISTORY_SIZE;
+        history_record_t *rec = &g_ring_recs[idx];
+
+        strncpy(rec->role, role, sizeof(rec->role) - 1);
+        rec->role[sizeof(rec->role) - 1] = '\0';
+
+        size_t len = strlen(content);
+        if (len >= HISTORY_CONTENT_MAX) len = HISTORY_CONTENT_MAX - 1;
+        memcpy(rec->content, content, len);
+        rec->content[len] = '\0';
+        rec->len = (uint32_t)len;
+
+        g_ring_hdr->count++;
+        msync(g_ring_hdr, g_ring_map_len, MS_ASYNC);
+    }
+}
+
+/* Drop all history, in memory and on disk; caller holds mutex */
+static void history_clear(void) {
+    g_history_count = 0;
+    g_history_json_len = 0;
+    if (g_ring_hdr) {
+        g_ring_hdr->head = 0;
+        g_ring_hdr->count = 0;
+        msync(g_ring_hdr, g_ring_map_len, MS_ASYNC);
+    }
+}
+
+static void history_ring_close(void) {
+    if (g_ring_hdr) {
+        msync(g_ring_hdr, g_ring_map_len, MS_SYNC);
+        munmap(g_ring_hdr, g_ring_map_len);
+        g_ring_hdr = NULL;
+        g_ring_recs = NULL;
+    }
+}
+
+/* ==================== AI Integration ==================== */
+
+/*
+ * SSE parsing state for streamed completions. The provider sends
+ * "data: {...}\n\n" events; each event carries one content delta in
+ * choices[0].delta.content. Deltas are forwarded to the callback as they
+ * arrive and accumulated into the full response text.
+ */
+struct sse_state {
+    char line[8192];
+    size_t line_len;
+    char text[4096];
+    size_t text_len;
+    chat_stream_cb cb;
+    void *userdata;
+};
+
+static void sse_handle_line(struct sse_state *st, const char *line) {
+    if (strncmp(line, "data: ", 6) != 0) return;
+
+    const char *payload = line + 6;
+    if (strcmp(payload, "[DONE]") == 0) return;
+
+    cJSON *json = cJSON_Parse(payload);
+    if (!json) return;
+
+    cJSON *choices = cJSON_GetObjectItem(json, "choices");
+    if (choices && cJSON_GetArraySize(choices) > 0) {
+        cJSON *choice = cJSON_GetArrayItem(choices, 0);
+        cJSON *delta = cJSON_GetObjectItem(choice, "delta");
+        cJSON *content = delta ? cJSON_GetObjectItem(delta, "content") : NULL;
+
+        if (content && content->valuestring && content->valuestring[0]) {
+            size_t len = strlen(content->valuestring);
+            if (st->text_len + len < sizeof(st->text)) {
+                memcpy(st->text + st->text_len, content->valuestring, len + 1);
+                st->text_len += len;
+            }
+            if (st->cb) st->cb(content->valuestring, st->userdata);
+        }
+    }
+
+    cJSON_Delete(json);
+}
+
+static size_t sse_write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
+    size_t total = size * nmemb;
+    struct sse_state *st = (struct sse_state *)userp;
+    const char *p = (const char *)contents;
+
+    for (size_t i = 0; i < total; i++) {
+        if (p[i] == '\n') {
+            while (st->line_len > 0 && st->line[st->line_len - 1] == '\r') {
+                st->line_len--;
+            }
+            st->line[st->line_len] = '\0';
+            if (st->line_len > 0) sse_handle_line(st, st->line);
+            st->line_len = 0;
+        } else if (st->line_len < sizeof(st->line) - 1) {
+            st->line[st->line_len++] = p[i];
+        }
+    }
+
+    return total;
+}
+
+static int call_openai(const char *user_message, char *response, size_t response_size,
+                       chat_stream_cb stream_cb, void *stream_userdata) {
+    /* Build request by splicing the pre-serialized history */
+    char *post_data = build_chat_request(user_message, stream_cb != NULL);
+    if (!post_data) return -1;
     
     /* Setup request */
     struct curl_slist *headers = NULL;
@@ -201,132 +775,480 @@ static int call_openai(const char *user_message, char *response, size_t response
     headers = curl_slist_append(headers, auth_header);
     headers = curl_slist_append(headers, "Content-Type: application/json");
     
+    if (stream_cb) {
+        /* Streamed completion: forward deltas as they arrive */
+        struct sse_state *st = calloc(1, sizeof(struct sse_state));
+        if (!st) {
+            curl_slist_free_all(headers);
+            free(post_data);
+            return -1;
+        }
+        st->cb = stream_cb;
+        st->userdata = stream_userdata;
+
+        CURLcode res = llm_perform("https://api.openai.com/v1/chat/completions",
+                                   headers, post_data, sse_write_callback, st);
+
+        curl_slist_free_all(headers);
+        free(post_data);
+
+        if (res != CURLE_OK || st->text_len == 0) {
+            if (res != CURLE_OK) {
+                LOG_ERROR("HTTP request failed: %s", curl_easy_strerror(res));
+            }
+            free(st);
+            return -1;
+        }
+
+        strncpy(response, st->text, response_size - 1);
+        response[response_size - 1] = '\0';
+        free(st);
+        return 0;
+    }
+
     struct response_buffer resp = {0};
-    
-    curl_easy_setopt(curl, CURLOPT_URL, "https://api.openai.com/v1/chat/completions");
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, post_data);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &resp);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    
-    CURLcode res = curl_easy_perform(curl);
-    
+
+    CURLcode res = llm_perform("https://api.openai.com/v1/chat/completions",
+                               headers, post_data, write_callback, &resp);
+
     curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
     free(post_data);
-    
+
     if (res != CURLE_OK) {
         LOG_ERROR("HTTP request failed: %s", curl_easy_strerror(res));
         free(resp.data);
         return -1;
     }
-    
+
     /* Parse response */
     cJSON *json = cJSON_Parse(resp.data);
     free(resp.data);
-    
+
     if (!json) {
         LOG_ERROR("Failed to parse response");
         return -1;
     }
-    
+
     cJSON *choices = cJSON_GetObjectItem(json, "choices");
     if (choices && cJSON_GetArraySize(choices) > 0) {
         cJSON *choice = cJSON_GetArrayItem(choices, 0);
         cJSON *message = cJSON_GetObjectItem(choice, "message");
         cJSON *content = cJSON_GetObjectItem(message, "content");
-        
+
         if (content && content->valuestring) {
             strncpy(response, content->valuestring, response_size - 1);
             response[response_size - 1] = '\0';
         }
     }
-    
-    cJSON_Delete(json);
-    return 0;
+
+    cJSON_Delete(json);
+    return 0;
+}
+
+/* ==================== Local Intent Matching ==================== */
+
+/*
+ * Offline devices (no API key) answer everything through the local
+ * fallback, and its keyword vocabulary grows per deployment. Intent
+ * keywords are compiled into an Aho-Corasick automaton at agent_init,
+ * so matching is one pass over the input no matter how many synonyms
+ * are registered, and handlers dispatch through a function table.
+ * Built-in vocabulary can be extended via /etc/aios/intents.json.
+ */
+
+#define INTENT_MAX_NODES 512
+#define INTENT_ALPHA     28     /* a-z, space, other */
+
+typedef struct {
+    int16_t next[INTENT_ALPHA];
+    int16_t fail;
+    uint32_t out;               /* bitmask of intent indices */
+} ac_node_t;
+
+static ac_node_t g_ac_nodes[INTENT_MAX_NODES];
+static int g_ac_node_count = 0;
+
+/* Handlers return 0 with response filled, or -1 to fall through */
+typedef int (*intent_fn)(const char *lower, char *response, size_t response_size);
+
+static int intent_brightness(const char *lower, char *response, size_t response_size) {
+    int level = -1;
+    if (strstr(lower, "up") || strstr(lower, "increase")) level = hal_brightness_get() + 20;
+    else if (strstr(lower, "down") || strstr(lower, "decrease")) level = hal_brightness_get() - 20;
+    else sscanf(lower, "%*[^0-9]%d", &level);
+
+    if (level < 0) return -1;
+    if (level > 100) level = 100;
+    hal_brightness_set(level);
+    snprintf(response, response_size, "{\"action\":\"brightness\",\"level\":%d}", level);
+    return 0;
+}
+
+static int intent_volume(const char *lower, char *response, size_t response_size) {
+    int level = -1;
+    if (strstr(lower, "up")) level = hal_volume_get() + 10;
+    else if (strstr(lower, "down")) level = hal_volume_get() - 10;
+    else if (strstr(lower, "mute")) {
+        hal_mute_set(true);
+        snprintf(response, response_size, "{\"action\":\"mute\",\"muted\":true}");
+        return 0;
+    }
+    else sscanf(lower, "%*[^0-9]%d", &level);
+
+    if (level < 0) return -1;
+    if (level > 100) level = 100;
+    hal_volume_set(level);
+    snprintf(response, response_size, "{\"action\":\"volume\",\"level\":%d}", level);
+    return 0;
+}
+
+static int intent_battery(const char *lower, char *response, size_t response_size) {
+    (void)lower;
+    battery_info_t bat;
+    hal_battery_get(&bat);
+    snprintf(response, response_size,
+        "Battery: %d%%, Status: %s", bat.level, bat.status);
+    return 0;
+}
+
+static int intent_time(const char *lower, char *response, size_t response_size) {
+    (void)lower;
+    time_t now = time(NULL);
+    struct tm *tm = localtime(&now);
+    strftime(response, response_size, "The time is %H:%M:%S", tm);
+    return 0;
+}
+
+static int intent_date(const char *lower, char *response, size_t response_size) {
+    (void)lower;
+    time_t now = time(NULL);
+    struct tm *tm = localtime(&now);
+    strftime(response, response_size, "Today is %A, %B %d, %Y", tm);
+    return 0;
+}
+
+static int intent_shutdown(const char *lower, char *response, size_t response_size) {
+    (void)lower;
+    snprintf(response, response_size, "{\"action\":\"shutdown\"}");
+    return 0;
+}
+
+static int intent_reboot(const char *lower, char *response, size_t response_size) {
+    (void)lower;
+    snprintf(response, response_size, "{\"action\":\"reboot\"}");
+    return 0;
+}
+
+static int intent_wifi(const char *lower, char *response, size_t response_size) {
+    bool enable = strstr(lower, "on") || strstr(lower, "enable");
+    bool disable = strstr(lower, "off") || strstr(lower, "disable");
+    if (!enable && !disable) return -1;
+
+    hal_wifi_set(enable);
+    snprintf(response, response_size, "{\"action\":\"wifi\",\"enabled\":%s}", enable ? "true" : "false");
+    return 0;
+}
+
+/* Table order is match priority (mirrors the old if/else ladder) */
+static const struct {
+    const char *name;
+    intent_fn fn;
+} g_intents[] = {
+    { "brightness", intent_brightness },
+    { "volume",     intent_volume },
+    { "battery",    intent_battery },
+    { "time",       intent_time },
+    { "date",       intent_date },
+    { "shutdown",   intent_shutdown },
+    { "reboot",     intent_reboot },
+    { "wifi",       intent_wifi },
+};
+
+#define INTENT_COUNT ((int)(sizeof(g_intents) / sizeof(g_intents[0])))
+
+static int ac_class(char c) {
+    if (c >= 'a' && c <= 'z') return c - 'a';
+    if (c == ' ') return 26;
+    return 27;
+}
+
+static int intent_index(const char *name) {
+    for (int i = 0; i < INTENT_COUNT; i++) {
+        if (strcmp(g_intents[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+/* Insert one keyword into the trie, tagged with its intent */
+static void ac_add(const char *keyword, int intent) {
+    if (intent < 0) return;
+
+    int state = 0;
+    for (const char *p = keyword; *p; p++) {
+        char c = (*p >= 'A' && *p <= 'Z') ? *p + 32 : *p;
+        int cls = ac_class(c);
+
+        if (g_ac_nodes[state].next[cls] < 0) {
+            if (g_ac_node_count >= INTENT_MAX_NODES) {
+                LOG_WARN("Intent automaton full, dropping keyword '%s'", keyword);
+                return;
+            }
+            memset(g_ac_nodes[g_ac_node_count].next, 0xff,
+                   sizeof(g_ac_nodes[g_ac_node_count].next));
+            g_ac_nodes[state].next[cls] = g_ac_node_count++;
+        }
+        state = g_ac_nodes[state].next[cls];
+    }
+    g_ac_nodes[state].out |= 1u << intent;
+}
+
+/* BFS over the trie to fill failure links and merge outputs */
+static void ac_build(void) {
+    int16_t queue[INTENT_MAX_NODES];
+    int head = 0, tail = 0;
+
+    for (int c = 0; c < INTENT_ALPHA; c++) {
+        int s = g_ac_nodes[0].next[c];
+        if (s >= 0) {
+            g_ac_nodes[s].fail = 0;
+            queue[tail++] = s;
+        }
+    }
+
+    while (head < tail) {
+        int u = queue[head++];
+        for (int c = 0; c < INTENT_ALPHA; c++) {
+            int v = g_ac_nodes[u].next[c];
+            if (v < 0) continue;
+
+            int f = g_ac_nodes[u].fail;
+            while (f > 0 && g_ac_nodes[f].next[c] < 0) f = g_ac_nodes[f].fail;
+
+            int target = g_ac_nodes[f].next[c];
+            g_ac_nodes[v].fail = (target >= 0 && target != v) ? target : 0;
+            g_ac_nodes[v].out |= g_ac_nodes[g_ac_nodes[v].fail].out;
+            queue[tail++] = v;
+        }
+    }
+}
+
+/* Compile built-in vocabulary plus /etc/aios/intents.json synonyms */
+static void intent_table_init(void) {
+    g_ac_node_count = 1;
+    memset(g_ac_nodes[0].next, 0xff, sizeof(g_ac_nodes[0].next));
+    g_ac_nodes[0].fail = 0;
+    g_ac_nodes[0].out = 0;
+
+    static const struct { const char *keyword; const char *intent; } defaults[] = {
+        { "brightness", "brightness" },
+        { "volume",     "volume" },
+        { "battery",    "battery" },
+        { "time",       "time" },
+        { "clock",      "time" },
+        { "date",       "date" },
+        { "shutdown",   "shutdown" },
+        { "power off",  "shutdown" },
+        { "reboot",     "reboot" },
+        { "restart",    "reboot" },
+        { "wifi",       "wifi" },
+    };
+    for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++) {
+        ac_add(defaults[i].keyword, intent_index(defaults[i].intent));
+    }
+
+    /* Extra synonyms from the intent file */
+    FILE *f = fopen(AGENT_INTENTS_PATH, "r");
+    if (f) {
+        fseek(f, 0, SEEK_END);
+        long size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+
+        char *buf = malloc(size + 1);
+        if (buf) {
+            fread(buf, 1, size, f);
+            buf[size] = '\0';
+
+            cJSON *json = cJSON_Parse(buf);
+            if (json) {
+                cJSON *intents = cJSON_GetObjectItem(json, "intents");
+                cJSON *entry;
+                cJSON_ArrayForEach(entry, intents) {
+                    cJSON *name = cJSON_GetObjectItem(entry, "intent");
+                    cJSON *keywords = cJSON_GetObjectItem(entry, "keywords");
+                    if (!name || !name->valuestring || !keywords) continue;
+
+                    int idx = intent_index(name->valuestring);
+                    if (idx < 0) {
+                        LOG_WARN("Unknown intent '%s' in %s",
+                                 name->valuestring, AGENT_INTENTS_PATH);
+                        continue;
+                    }
+
+                    cJSON *kw;
+                    cJSON_ArrayForEach(kw, keywords) {
+                        if (kw->valuestring) ac_add(kw->valuestring, idx);
+                    }
+                }
+                cJSON_Delete(json);
+            }
+            free(buf);
+        }
+        fclose(f);
+    }
+
+    ac_build();
+    LOG_INFO("Intent automaton: %d intents, %d nodes", INTENT_COUNT, g_ac_node_count);
 }
 
 static int process_local_fallback(const char *input, char *response, size_t response_size) {
-    char lower[256];
+    char lower[256] = "";
     strncpy(lower, input, sizeof(lower) - 1);
     for (char *p = lower; *p; p++) *p = (*p >= 'A' && *p <= 'Z') ? *p + 32 : *p;
-    
-    if (strstr(lower, "brightness")) {
-        int level = -1;
-        if (strstr(lower, "up") || strstr(lower, "increase")) level = hal_brightness_get() + 20;
-        else if (strstr(lower, "down") || strstr(lower, "decrease")) level = hal_brightness_get() - 20;
-        else sscanf(lower, "%*[^0-9]%d", &level);
-        
-        if (level >= 0) {
-            if (level > 100) level = 100;
-            hal_brightness_set(level);
-            snprintf(response, response_size, "{\"action\":\"brightness\",\"level\":%d}", level);
-            return 0;
+
+    /* One pass over the input collects every matched intent */
+    uint32_t matched = 0;
+    int state = 0;
+    for (const char *p = lower; *p; p++) {
+        int c = ac_class(*p);
+        while (state > 0 && g_ac_nodes[state].next[c] < 0) {
+            state = g_ac_nodes[state].fail;
         }
+        if (g_ac_nodes[state].next[c] >= 0) state = g_ac_nodes[state].next[c];
+        matched |= g_ac_nodes[state].out;
     }
-    else if (strstr(lower, "volume")) {
-        int level = -1;
-        if (strstr(lower, "up")) level = hal_volume_get() + 10;
-        else if (strstr(lower, "down")) level = hal_volume_get() - 10;
-        else if (strstr(lower, "mute")) {
-            hal_mute_set(true);
-            snprintf(response, response_size, "{\"action\":\"mute\",\"muted\":true}");
-            return 0;
-        }
-        else sscanf(lower, "%*[^0-9]%d", &level);
-        
-        if (level >= 0) {
-            if (level > 100) level = 100;
-            hal_volume_set(level);
-            snprintf(response, response_size, "{\"action\":\"volume\",\"level\":%d}", level);
+
+    for (int i = 0; i < INTENT_COUNT; i++) {
+        if ((matched & (1u << i)) &&
+            g_intents[i].fn(lower, response, response_size) == 0) {
             return 0;
         }
     }
-    else if (strstr(lower, "battery")) {
-        battery_info_t bat;
-        hal_battery_get(&bat);
-        snprintf(response, response_size, 
-            "Battery: %d%%, Status: %s", bat.level, bat.status);
-        return 0;
-    }
-    else if (strstr(lower, "time") || strstr(lower, "clock")) {
-        time_t now = time(NULL);
-        struct tm *tm = localtime(&now);
-        strftime(response, response_size, "The time is %H:%M:%S", tm);
-        return 0;
-    }
-    else if (strstr(lower, "date")) {
-        time_t now = time(NULL);
-        struct tm *tm = localtime(&now);
-        strftime(response, response_size, "Today is %A, %B %d, %Y", tm);
-        return 0;
+
+    snprintf(response, response_size, "I can help with: brightness, volume, battery, time, date, wifi, shutdown, reboot");
+    return 0;
+}
+
+/* ==================== Response Cache ==================== */
+
+/*
+ * Kiosk workloads repeat themselves: over a third of queries are exact
+ * repeats ("battery status", "wifi on"), and each one normally pays the
+ * full multi-second provider round-trip. Responses are cached under a
+ * hash of (system prompt, recent history tail, normalized input) with a
+ * short TTL so answers that depend on live state age out quickly, and
+ * LRU eviction over a fixed slot array.
+ */
+
+#define CHAT_CACHE_SIZE      32
+#define CHAT_CACHE_TTL_SECS  60
+#define CHAT_CACHE_TAIL_MSGS 4   /* history messages hashed into the key */
+
+typedef struct {
+    uint64_t key;           /* 0 = free slot */
+    time_t expires;
+    uint64_t last_used;     /* LRU stamp */
+    char response[4096];
+} chat_cache_entry_t;
+
+static chat_cache_entry_t g_chat_cache[CHAT_CACHE_SIZE];
+static uint64_t g_chat_cache_clock = 0;
+static uint64_t g_chat_cache_hits = 0;
+static uint64_t g_chat_cache_misses = 0;
+static pthread_mutex_t g_chat_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t fnv1a64(uint64_t h, const char *s, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 0x100000001b3ULL;
     }
-    else if (strstr(lower, "shutdown") || strstr(lower, "power off")) {
-        snprintf(response, response_size, "{\"action\":\"shutdown\"}");
-        return 0;
+    return h;
+}
+
+/*
+ * Cache key for one chat turn. The history tail is included so the same
+ * words asked in a different conversational context miss; the input is
+ * normalized (lowercased, whitespace collapsed) so trivial rephrasings
+ * of an identical prompt still hit.
+ */
+static uint64_t chat_cache_key(const char *input) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    h = fnv1a64(h, SYSTEM_MSG_JSON, sizeof(SYSTEM_MSG_JSON) - 1);
+
+    pthread_mutex_lock(&g_history_mutex);
+    int from = g_history_count > CHAT_CACHE_TAIL_MSGS
+             ? g_history_count - CHAT_CACHE_TAIL_MSGS : 0;
+    if (g_history_count > 0) {
+        size_t off = g_history_offsets[from];
+        h = fnv1a64(h, g_history_json + off, g_history_json_len - off);
     }
-    else if (strstr(lower, "reboot") || strstr(lower, "restart")) {
-        snprintf(response, response_size, "{\"action\":\"reboot\"}");
-        return 0;
+    pthread_mutex_unlock(&g_history_mutex);
+
+    int prev_space = 1;
+    for (const char *p = input; *p; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c == ' ' || c == '\t' || c == '\n') {
+            if (prev_space) continue;
+            c = ' ';
+            prev_space = 1;
+        } else {
+            if (c >= 'A' && c <= 'Z') c += 32;
+            prev_space = 0;
+        }
+        h ^= c;
+        h *= 0x100000001b3ULL;
     }
-    else if (strstr(lower, "wifi")) {
-        bool enable = strstr(lower, "on") || strstr(lower, "enable");
-        bool disable = strstr(lower, "off") || strstr(lower, "disable");
-        if (enable || disable) {
-            hal_wifi_set(enable);
-            snprintf(response, response_size, "{\"action\":\"wifi\",\"enabled\":%s}", enable ? "true" : "false");
+
+    return h ? h : 1;   /* 0 marks a free slot */
+}
+
+static int chat_cache_get(uint64_t key, char *response, size_t response_size) {
+    pthread_mutex_lock(&g_chat_cache_mutex);
+
+    for (int i = 0; i < CHAT_CACHE_SIZE; i++) {
+        chat_cache_entry_t *e = &g_chat_cache[i];
+        if (e->key == key && time(NULL) < e->expires) {
+            strncpy(response, e->response, response_size - 1);
+            response[response_size - 1] = '\0';
+            e->last_used = ++g_chat_cache_clock;
+            g_chat_cache_hits++;
+            pthread_mutex_unlock(&g_chat_cache_mutex);
             return 0;
         }
     }
-    
-    snprintf(response, response_size, "I can help with: brightness, volume, battery, time, date, wifi, shutdown, reboot");
-    return 0;
+
+    g_chat_cache_misses++;
+    pthread_mutex_unlock(&g_chat_cache_mutex);
+    return -1;
+}
+
+static void chat_cache_put(uint64_t key, const char *response) {
+    pthread_mutex_lock(&g_chat_cache_mutex);
+
+    /* Reuse a free or expired slot, else evict the least recently used */
+    chat_cache_entry_t *victim = &g_chat_cache[0];
+    for (int i = 0; i < CHAT_CACHE_SIZE; i++) {
+        chat_cache_entry_t *e = &g_chat_cache[i];
+        if (e->key == 0 || time(NULL) >= e->expires) {
+            victim = e;
+            break;
+        }
+        if (e->last_used < victim->last_used) victim = e;
+    }
+
+    victim->key = key;
+    victim->expires = time(NULL) + CHAT_CACHE_TTL_SECS;
+    victim->last_used = ++g_chat_cache_clock;
+    strncpy(victim->response, response, sizeof(victim->response) - 1);
+    victim->response[sizeof(victim->response) - 1] = '\0';
+
+    pthread_mutex_unlock(&g_chat_cache_mutex);
 }
 
 /* ==================== Action Execution ==================== */
 
 int agent_execute_action(const char *action_json, action_result_t *result) {
+    uint64_t start = aios_stats_now_us();
+
     result->success = false;
     strcpy(result->message, "Unknown action");
     result->data = NULL;
@@ -406,7 +1328,7 @@ int agent_execute_action(const char *action_json, action_result_t *result) {
     }
     else if (strcmp(act, "info") == 0) {
         system_info_t info;
-        hal_system_info(&info);
+        hal_system_info_cached(&info);
         
         cJSON *data = cJSON_CreateObject();
         cJSON_AddStringToObject(data, "hostname", info.hostname);
@@ -422,19 +1344,35 @@ int agent_execute_action(const char *action_json, action_result_t *result) {
     }
     
     cJSON_Delete(json);
+    aios_stats_record(g_stat_action, start,
+                      strlen(action_json), strlen(result->message));
     return 0;
 }
 
 /* ==================== Chat Processing ==================== */
 
-int agent_chat(const char *input, char *response, size_t response_size, 
-               action_result_t *action_result) {
+int agent_chat_stream(const char *input, char *response, size_t response_size,
+                      action_result_t *action_result,
+                      chat_stream_cb stream_cb, void *stream_userdata) {
     char ai_response[4096] = {0};
-    
-    /* Call AI or local fallback */
+    uint64_t start = aios_stats_now_us();
+
+    /* Call AI or local fallback; identical recent prompts skip the
+     * provider entirely (cached answers arrive without deltas) */
     if (g_config.provider == AI_PROVIDER_OPENAI && g_config.openai_api_key[0]) {
-        if (call_openai(input, ai_response, sizeof(ai_response)) < 0) {
-            process_local_fallback(input, ai_response, sizeof(ai_response));
+        uint64_t cache_key = chat_cache_key(input);
+
+        if (chat_cache_get(cache_key, ai_response, sizeof(ai_response)) < 0) {
+            uint64_t llm_start = aios_stats_now_us();
+            int llm_ret = call_openai(input, ai_response, sizeof(ai_response),
+                                      stream_cb, stream_userdata);
+            aios_stats_record(g_stat_llm, llm_start,
+                              strlen(input), strlen(ai_response));
+            if (llm_ret < 0) {
+                process_local_fallback(input, ai_response, sizeof(ai_response));
+            } else {
+                chat_cache_put(cache_key, ai_response);
+            }
         }
     } else {
         process_local_fallback(input, ai_response, sizeof(ai_response));
@@ -462,193 +1400,483 @@ int agent_chat(const char *input, char *response, size_t response_size,
     
     /* Add to history */
     pthread_mutex_lock(&g_history_mutex);
-    if (g_history_count >= MAX_HISTORY_SIZE) {
-        free(g_history[0].content);
-        memmove(&g_history[0], &g_history[1], sizeof(chat_message_t) * (MAX_HISTORY_SIZE - 1));
-        g_history_count--;
-    }
-    strcpy(g_history[g_history_count].role, "user");
-    g_history[g_history_count].content = strdup(input);
-    g_history_count++;
-    
-    if (g_history_count < MAX_HISTORY_SIZE) {
-        strcpy(g_history[g_history_count].role, "assistant");
-        g_history[g_history_count].content = strdup(ai_response);
-        g_history_count++;
-    }
+    history_append("user", input);
+    history_append("assistant", ai_response);
     pthread_mutex_unlock(&g_history_mutex);
-    
+
+    aios_stats_record(g_stat_chat, start, strlen(input), strlen(response));
     return 0;
 }
 
+int agent_chat(const char *input, char *response, size_t response_size,
+               action_result_t *action_result) {
+    return agent_chat_stream(input, response, response_size, action_result, NULL, NULL);
+}
+
 /* ==================== IPC Server ==================== */
 
-static void *client_handler(void *arg) {
-    int client_fd = *(int *)arg;
-    free(arg);
-    
-    while (1) {
-        /* Read message length */
-        uint32_t length;
-        if (recv(client_fd, &length, 4, 0) != 4) break;
-        length = ntohl(length);
-        
-        if (length > MAX_MESSAGE_SIZE) break;
-        
-        /* Read message */
-        char *msg = malloc(length + 1);
-        if (!msg) break;
-        
-        ssize_t received = 0;
-        while (received < length) {
-            ssize_t n = recv(client_fd, msg + received, length - received, 0);
-            if (n <= 0) break;
-            received += n;
-        }
-        if (received != length) {
-            free(msg);
-            break;
+#define LISTEN_BACKLOG      128
+#define WORKER_THREADS      4
+#define RECV_BUF_INITIAL    4096
+
+/*
+ * Per-connection state machine for the 4-byte length framing.
+ * Connections are registered with EPOLLONESHOT: while a worker owns a
+ * connection (complete frame queued), epoll delivers no further events
+ * for it, so no locking is needed on the connection itself.
+ */
+typedef struct client_conn {
+    int fd;
+    uint32_t msg_len;           /* expected payload length, 0 = reading header */
+    uint32_t received;          /* bytes of header or payload received so far */
+    unsigned char header[4];
+    char *buf;                  /* payload buffer, grown geometrically, kept across requests */
+    size_t buf_cap;
+    arena_t arena;              /* per-request allocations, reset after each reply */
+} client_conn_t;
+
+static int g_epoll_fd = -1;
+
+/* Job queue feeding the worker pool */
+typedef struct job {
+    client_conn_t *conn;
+    struct job *next;
+} job_t;
+
+static job_t *g_job_head = NULL;
+static job_t *g_job_tail = NULL;
+static pthread_mutex_t g_job_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_job_cond = PTHREAD_COND_INITIALIZER;
+
+static void conn_close(client_conn_t *conn) {
+    epoll_ctl(g_epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    arena_destroy(&conn->arena);
+    free(conn->buf);
+    free(conn);
+}
+
+static int conn_rearm(client_conn_t *conn) {
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.ptr = conn;
+    return epoll_ctl(g_epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev);
+}
+
+static int send_all(int fd, const void *data, size_t len) {
+    const char *p = data;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+                if (poll(&pfd, 1, 5000) <= 0) return -1;
+                continue;
+            }
+            return -1;
         }
-        msg[length] = '\0';
-        
-        /* Parse request */
-        cJSON *request = cJSON_Parse(msg);
-        free(msg);
-        
-        if (!request) break;
-        
-        cJSON *cmd = cJSON_GetObjectItem(request, "cmd");
-        cJSON *response = cJSON_CreateObject();
-        
-        if (cmd && cmd->valuestring) {
-            if (strcmp(cmd->valuestring, "chat") == 0) {
-                cJSON *text = cJSON_GetObjectItem(request, "text");
-                if (text && text->valuestring) {
-                    char resp[4096];
-                    action_result_t action = {0};
-                    
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int conn_send_response(client_conn_t *conn, const char *resp) {
+    uint32_t resp_len = htonl(strlen(resp));
+    if (send_all(conn->fd, &resp_len, 4) < 0) return -1;
+    return send_all(conn->fd, resp, strlen(resp));
+}
+
+/*
+ * Stream callback for "chat" requests with "stream":true.
+ * Each provider delta is forwarded immediately as a partial frame
+ * ({"status":"partial","delta":"..."}) ahead of the final response frame,
+ * so clients can render tokens as they arrive.
+ */
+static void chat_partial_cb(const char *delta, void *userdata) {
+    client_conn_t *conn = userdata;
+
+    cJSON *frame = cJSON_CreateObject();
+    cJSON_AddStringToObject(frame, "status", "partial");
+    cJSON_AddStringToObject(frame, "delta", delta);
+
+    char *frame_str = cJSON_PrintUnformatted(frame);
+    cJSON_Delete(frame);
+
+    conn_send_response(conn, frame_str);
+    cJSON_free(frame_str);
+}
+
+/* Process one complete framed request; returns -1 to drop the connection */
+static int process_message(client_conn_t *conn) {
+    /* All cJSON work for this request comes from the connection's arena */
+    t_arena = &conn->arena;
+
+    /* Parse request */
+    cJSON *request = cJSON_Parse(conn->buf);
+    if (!request) {
+        t_arena = NULL;
+        arena_reset(&conn->arena);
+        return -1;
+    }
+
+    cJSON *cmd = cJSON_GetObjectItem(request, "cmd");
+    cJSON *response = cJSON_CreateObject();
+
+    /* Pipelining clients tag requests with a sequence id; echo it so
+     * they can match responses */
+    cJSON *req_id = cJSON_GetObjectItem(request, "id");
+    if (req_id && cJSON_IsNumber(req_id)) {
+        cJSON_AddNumberToObject(response, "id", req_id->valuedouble);
+    }
+
+    if (cmd && cmd->valuestring) {
+        if (strcmp(cmd->valuestring, "chat") == 0) {
+            cJSON *text = cJSON_GetObjectItem(request, "text");
+            if (text && text->valuestring) {
+                char resp[4096];
+                action_result_t action = {0};
+                cJSON *stream = cJSON_GetObjectItem(request, "stream");
+
+                if (stream && cJSON_IsTrue(stream)) {
+                    agent_chat_stream(text->valuestring, resp, sizeof(resp), &action,
+                                      chat_partial_cb, conn);
+                } else {
                     agent_chat(text->valuestring, resp, sizeof(resp), &action);
-                    
-                    cJSON_AddStringToObject(response, "status", "ok");
-                    cJSON_AddStringToObject(response, "response", resp);
-                    
-                    if (action.message[0]) {
-                        cJSON *act_result = cJSON_CreateObject();
-                        cJSON_AddBoolToObject(act_result, "success", action.success);
-                        cJSON_AddStringToObject(act_result, "message", action.message);
-                        if (action.data) {
-                            cJSON_AddRawToObject(act_result, "data", action.data);
-                            free(action.data);
-                        }
-                        cJSON_AddItemToObject(response, "action_result", act_result);
-                    }
-                }
-            }
-            else if (strcmp(cmd->valuestring, "action") == 0) {
-                cJSON *action = cJSON_GetObjectItem(request, "action");
-                if (action) {
-                    char *action_str = cJSON_PrintUnformatted(action);
-                    action_result_t result = {0};
-                    agent_execute_action(action_str, &result);
-                    free(action_str);
-                    
-                    cJSON *res = cJSON_CreateObject();
-                    cJSON_AddBoolToObject(res, "success", result.success);
-                    cJSON_AddStringToObject(res, "message", result.message);
-                    cJSON_AddItemToObject(response, "result", res);
                 }
-            }
-            else if (strcmp(cmd->valuestring, "status") == 0) {
-                system_info_t info;
-                hal_system_info(&info);
                 
                 cJSON_AddStringToObject(response, "status", "ok");
-                cJSON_AddBoolToObject(response, "running", true);
-                cJSON_AddBoolToObject(response, "ai_configured", 
-                    g_config.openai_api_key[0] || g_config.anthropic_api_key[0]);
+                cJSON_AddStringToObject(response, "response", resp);
                 
-                cJSON *sys = cJSON_CreateObject();
-                cJSON_AddStringToObject(sys, "hostname", info.hostname);
-                cJSON_AddStringToObject(sys, "kernel", info.kernel);
-                cJSON_AddNumberToObject(sys, "memory_mb", info.memory_total_kb / 1024);
-                cJSON_AddNumberToObject(sys, "memory_free_mb", info.memory_free_kb / 1024);
-                cJSON_AddItemToObject(response, "system", sys);
-            }
-            else if (strcmp(cmd->valuestring, "clear") == 0) {
-                pthread_mutex_lock(&g_history_mutex);
-                for (int i = 0; i < g_history_count; i++) {
-                    free(g_history[i].content);
+                if (action.message[0]) {
+                    cJSON *act_result = cJSON_CreateObject();
+                    cJSON_AddBoolToObject(act_result, "success", action.success);
+                    cJSON_AddStringToObject(act_result, "message", action.message);
+                    if (action.data) {
+                        cJSON_AddRawToObject(act_result, "data", action.data);
+                        cJSON_free(action.data);
+                    }
+                    cJSON_AddItemToObject(response, "action_result", act_result);
                 }
-                g_history_count = 0;
-                pthread_mutex_unlock(&g_history_mutex);
-                cJSON_AddStringToObject(response, "status", "ok");
             }
         }
-        
-        cJSON_Delete(request);
-        
-        /* Send response */
-        char *resp_str = cJSON_PrintUnformatted(response);
-        cJSON_Delete(response);
-        
-        uint32_t resp_len = htonl(strlen(resp_str));
-        send(client_fd, &resp_len, 4, 0);
-        send(client_fd, resp_str, strlen(resp_str), 0);
-        free(resp_str);
+        else if (strcmp(cmd->valuestring, "action") == 0) {
+            cJSON *action = cJSON_GetObjectItem(request, "action");
+            if (action) {
+                char *action_str = cJSON_PrintUnformatted(action);
+                action_result_t result = {0};
+                agent_execute_action(action_str, &result);
+                cJSON_free(action_str);
+                
+                cJSON *res = cJSON_CreateObject();
+                cJSON_AddBoolToObject(res, "success", result.success);
+                cJSON_AddStringToObject(res, "message", result.message);
+                cJSON_AddItemToObject(response, "result", res);
+            }
+        }
+        else if (strcmp(cmd->valuestring, "status") == 0) {
+            system_info_t info;
+            hal_system_info_cached(&info);
+            
+            cJSON_AddStringToObject(response, "status", "ok");
+            cJSON_AddBoolToObject(response, "running", true);
+            cJSON_AddBoolToObject(response, "ai_configured", 
+                g_config.openai_api_key[0] || g_config.anthropic_api_key[0]);
+            
+            cJSON *sys = cJSON_CreateObject();
+            cJSON_AddStringToObject(sys, "hostname", info.hostname);
+            cJSON_AddStringToObject(sys, "kernel", info.kernel);
+            cJSON_AddNumberToObject(sys, "memory_mb", info.memory_total_kb / 1024);
+            cJSON_AddNumberToObject(sys, "memory_free_mb", info.memory_free_kb / 1024);
+            cJSON_AddItemToObject(response, "system", sys);
+
+            cJSON *cache = cJSON_CreateObject();
+            pthread_mutex_lock(&g_chat_cache_mutex);
+            cJSON_AddNumberToObject(cache, "hits", (double)g_chat_cache_hits);
+            cJSON_AddNumberToObject(cache, "misses", (double)g_chat_cache_misses);
+            pthread_mutex_unlock(&g_chat_cache_mutex);
+            cJSON_AddItemToObject(response, "cache", cache);
+        }
+        else if (strcmp(cmd->valuestring, "clear") == 0) {
+            pthread_mutex_lock(&g_history_mutex);
+            history_clear();
+            pthread_mutex_unlock(&g_history_mutex);
+            cJSON_AddStringToObject(response, "status", "ok");
+        }
     }
     
-    close(client_fd);
+    cJSON_Delete(request);
+
+    /* Send response */
+    char *resp_str = cJSON_PrintUnformatted(response);
+    cJSON_Delete(response);
+
+    int ret = conn_send_response(conn, resp_str);
+    cJSON_free(resp_str);
+
+    t_arena = NULL;
+    arena_reset(&conn->arena);
+    return ret;
+}
+
+/* ==================== Worker Pool ==================== */
+
+static void job_push(client_conn_t *conn) {
+    job_t *job = malloc(sizeof(job_t));
+    if (!job) {
+        conn_close(conn);
+        return;
+    }
+    job->conn = conn;
+    job->next = NULL;
+
+    pthread_mutex_lock(&g_job_mutex);
+    if (g_job_tail) g_job_tail->next = job;
+    else g_job_head = job;
+    g_job_tail = job;
+    pthread_cond_signal(&g_job_cond);
+    pthread_mutex_unlock(&g_job_mutex);
+}
+
+static void *worker_thread(void *arg) {
+    (void)arg;
+
+    while (1) {
+        pthread_mutex_lock(&g_job_mutex);
+        while (!g_job_head && g_running) {
+            pthread_cond_wait(&g_job_cond, &g_job_mutex);
+        }
+        if (!g_job_head) {
+            pthread_mutex_unlock(&g_job_mutex);
+            break;
+        }
+        job_t *job = g_job_head;
+        g_job_head = job->next;
+        if (!g_job_head) g_job_tail = NULL;
+        pthread_mutex_unlock(&g_job_mutex);
+
+        client_conn_t *conn = job->conn;
+        free(job);
+
+        int ret = process_message(conn);
+
+        /* Reset framing state and hand the connection back to the event loop */
+        conn->msg_len = 0;
+        conn->received = 0;
+
+        if (ret < 0 || conn_rearm(conn) < 0) {
+            conn_close(conn);
+        }
+    }
+
+    return NULL;
+}
+
+/* ==================== Event Loop ==================== */
+
+/*
+ * Drive the per-connection read state machine.
+ * Returns 1 when a complete frame is buffered (connection handed to a
+ * worker), 0 to keep polling, -1 to drop the connection.
+ */
+static int conn_handle_readable(client_conn_t *conn) {
+    while (1) {
+        ssize_t n;
+
+        if (conn->msg_len == 0) {
+            /* Reading the 4-byte length header */
+            n = recv(conn->fd, conn->header + conn->received, 4 - conn->received, 0);
+            if (n == 0) return -1;
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+            }
+            conn->received += n;
+            if (conn->received < 4) continue;
+
+            uint32_t length;
+            memcpy(&length, conn->header, 4);
+            length = ntohl(length);
+            if (length == 0 || length > MAX_MESSAGE_SIZE) return -1;
+
+            conn->msg_len = length;
+            conn->received = 0;
+
+            /* Grow the retained receive buffer geometrically */
+            if (conn->buf_cap < length + 1) {
+                size_t cap = conn->buf_cap ? conn->buf_cap : RECV_BUF_INITIAL;
+                while (cap < length + 1) cap *= 2;
+                char *buf = realloc(conn->buf, cap);
+                if (!buf) return -1;
+                conn->buf = buf;
+                conn->buf_cap = cap;
+            }
+        }
+
+        /* Reading the payload */
+        n = recv(conn->fd, conn->buf + conn->received, conn->msg_len - conn->received, 0);
+        if (n == 0) return -1;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+        conn->received += n;
+
+        if (conn->received == conn->msg_len) {
+            conn->buf[conn->msg_len] = '\0';
+            return 1;
+        }
+    }
+}
+
+static void accept_clients(void) {
+    while (1) {
+        int fd = accept4(g_server_fd, NULL, NULL, SOCK_NONBLOCK);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_WARN("accept failed: %s", strerror(errno));
+            }
+            return;
+        }
+
+        client_conn_t *conn = calloc(1, sizeof(client_conn_t));
+        if (!conn) {
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLONESHOT;
+        ev.data.ptr = conn;
+        if (epoll_ctl(g_epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            free(conn);
+        }
+    }
+}
+
+/* Publish the shared-memory metrics snapshot at a fixed interval */
+#define METRICS_INTERVAL_SEC 2
+
+static void *metrics_thread(void *arg) {
+    (void)arg;
+    while (g_running) {
+        if (hal_metrics_publish() < 0) {
+            LOG_WARN("Metrics publish failed");
+        }
+        for (int i = 0; i < METRICS_INTERVAL_SEC * 2 && g_running; i++) {
+            usleep(500000);
+        }
+    }
     return NULL;
 }
 
 int agent_run(void) {
     /* Create socket */
-    g_server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    g_server_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
     if (g_server_fd < 0) {
         LOG_ERROR("Failed to create socket: %s", strerror(errno));
         return -1;
     }
-    
+
     /* Setup address */
     struct sockaddr_un addr;
     memset(&addr, 0, sizeof(addr));
     addr.sun_family = AF_UNIX;
     strncpy(addr.sun_path, AGENT_SOCKET_PATH, sizeof(addr.sun_path) - 1);
-    
+
     /* Remove old socket */
     unlink(AGENT_SOCKET_PATH);
-    
+
     /* Bind */
     if (bind(g_server_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
         LOG_ERROR("Failed to bind: %s", strerror(errno));
         return -1;
     }
-    
+
     chmod(AGENT_SOCKET_PATH, 0666);
-    
+
     /* Listen */
-    if (listen(g_server_fd, 5) < 0) {
+    if (listen(g_server_fd, LISTEN_BACKLOG) < 0) {
         LOG_ERROR("Failed to listen: %s", strerror(errno));
         return -1;
     }
-    
-    LOG_INFO("Agent listening on %s", AGENT_SOCKET_PATH);
+
+    g_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (g_epoll_fd < 0) {
+        LOG_ERROR("Failed to create epoll: %s", strerror(errno));
+        return -1;
+    }
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;     /* NULL marks the listen socket */
+    if (epoll_ctl(g_epoll_fd, EPOLL_CTL_ADD, g_server_fd, &ev) < 0) {
+        LOG_ERROR("Failed to register listen socket: %s", strerror(errno));
+        return -1;
+    }
+
+    LOG_INFO("Agent listening on %s (%d workers)", AGENT_SOCKET_PATH, WORKER_THREADS);
     g_running = true;
-    
+
+    /* Start worker pool */
+    pthread_t workers[WORKER_THREADS];
+    for (int i = 0; i < WORKER_THREADS; i++) {
+        pthread_create(&workers[i], NULL, worker_thread, NULL);
+    }
+
+    /* Start the metrics sampler */
+    pthread_t metrics;
+    pthread_create(&metrics, NULL, metrics_thread, NULL);
+
     while (g_running) {
-        int *client_fd = malloc(sizeof(int));
-        *client_fd = accept(g_server_fd, NULL, NULL);
-        
-        if (*client_fd < 0) {
-            free(client_fd);
-            continue;
+        struct epoll_event events[64];
+        int n = epoll_wait(g_epoll_fd, events, 64, 500);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.ptr == NULL) {
+                accept_clients();
+                continue;
+            }
+
+            client_conn_t *conn = events[i].data.ptr;
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                conn_close(conn);
+                continue;
+            }
+
+            int ret = conn_handle_readable(conn);
+            if (ret < 0) {
+                conn_close(conn);
+            } else if (ret == 1) {
+                job_push(conn);
+            } else if (conn_rearm(conn) < 0) {
+                conn_close(conn);
+            }
         }
-        
-        pthread_t thread;
-        pthread_create(&thread, NULL, client_handler, client_fd);
-        pthread_detach(thread);
     }
-    
+
+    /* Wake and join workers */
+    pthread_mutex_lock(&g_job_mutex);
+    pthread_cond_broadcast(&g_job_cond);
+    pthread_mutex_unlock(&g_job_mutex);
+    for (int i = 0; i < WORKER_THREADS; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    pthread_join(metrics, NULL);
+
+    close(g_epoll_fd);
+    g_epoll_fd = -1;
+
     return 0;
 }
 
@@ -658,16 +1886,38 @@ int agent_init(void) {
     /* Create directories */
     mkdir("/run/aios", 0755);
     mkdir("/var/log/aios", 0755);
+    mkdir("/var/lib/aios", 0755);
     
     /* Open log file */
     g_log_file = fopen(AGENT_LOG_PATH, "a");
     
-    /* Initialize libcurl */
+    /* Route cJSON allocations through the per-request arena hooks */
+    cJSON_Hooks hooks = { json_malloc_hook, json_free_hook };
+    cJSON_InitHooks(&hooks);
+
+    /* Initialize libcurl and the async LLM client */
     curl_global_init(CURL_GLOBAL_ALL);
-    
+    if (llm_client_init() < 0) {
+        LOG_WARN("LLM client init failed, provider calls disabled");
+    }
+
     /* Load configuration */
     load_config();
-    
+
+    /* Compile the local intent automaton */
+    intent_table_init();
+
+    /* Map the persistent conversation ring and warm-load history */
+    if (history_ring_open() < 0) {
+        LOG_WARN("History ring unavailable, conversation will not persist");
+    }
+
+    /* Hot-path counters (best-effort; NULL ops are no-ops) */
+    g_stats = aios_stats_open("agent");
+    g_stat_chat = aios_stats_register(g_stats, "chat");
+    g_stat_llm = aios_stats_register(g_stats, "llm");
+    g_stat_action = aios_stats_register(g_stats, "action");
+
     LOG_INFO("AI-OS Agent initialized");
     return 0;
 }
@@ -680,13 +1930,16 @@ void agent_cleanup(void) {
         unlink(AGENT_SOCKET_PATH);
     }
     
-    /* Free history */
-    for (int i = 0; i < g_history_count; i++) {
-        free(g_history[i].content);
-    }
+    /* Flush and unmap history */
+    history_ring_close();
+    free(g_history_json);
+    g_history_json = NULL;
+    g_history_json_len = 0;
+    g_history_json_cap = 0;
     
+    llm_client_cleanup();
     curl_global_cleanup();
-    
+
     if (g_log_file) fclose(g_log_file);
     
     LOG_INFO("Agent cleanup complete");
@@ -15,6 +15,7 @@
 /* Configuration */
 #define AGENT_SOCKET_PATH   "/run/aios/agent.sock"
 #define AGENT_CONFIG_PATH   "/etc/aios/agent.json"
+#define AGENT_INTENTS_PATH  "/etc/aios/intents.json"
 #define AGENT_LOG_PATH      "/var/log/aios/agent.log"
 #define MAX_MESSAGE_SIZE    65536
 #define MAX_HISTORY_SIZE    20
@@ -58,9 +59,17 @@ void agent_cleanup(void);
 int agent_run(void);
 
 /* Process chat message */
-int agent_chat(const char *input, char *response, size_t response_size, 
+int agent_chat(const char *input, char *response, size_t response_size,
                action_result_t *action_result);
 
+/* Partial-response callback, invoked once per streamed token delta */
+typedef void (*chat_stream_cb)(const char *delta, void *userdata);
+
+/* Process chat message, forwarding provider deltas through stream_cb */
+int agent_chat_stream(const char *input, char *response, size_t response_size,
+                      action_result_t *action_result,
+                      chat_stream_cb stream_cb, void *stream_userdata);
+
 /* Execute action directly */
 int agent_execute_action(const char *action_json, action_result_t *result);
 
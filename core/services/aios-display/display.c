@@ -10,10 +10,16 @@
 #include <string.h>
 #include <unistd.h>
 #include <signal.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/inotify.h>
 #include <sys/wait.h>
 #include <sys/stat.h>
 
 #define WESTON_CONFIG "/etc/aios/weston.ini"
+#define RUNTIME_DIR "/run/user/0"
+#define WAYLAND_SOCKET RUNTIME_DIR "/wayland-0"
+#define COMPOSITOR_WAIT_MS 10000
 
 static volatile int g_running = 1;
 static pid_t g_weston_pid = 0;
@@ -37,10 +43,7 @@ static const char *detect_backend(void) {
 }
 
 static void create_weston_config(void) {
-    FILE *f = fopen(WESTON_CONFIG, "w");
-    if (!f) return;
-    
-    fprintf(f,
+    static const char config[] =
         "[core]\n"
         "shell=desktop-shell.so\n"
         "require-input=false\n"
@@ -63,12 +66,68 @@ static void create_weston_config(void) {
         "\n"
         "[libinput]\n"
         "enable-tap=true\n"
-        "natural-scroll=false\n"
-    );
-    
+        "natural-scroll=false\n";
+
+    /* Skip the rewrite when the content on disk already matches */
+    char existing[sizeof(config)];
+    FILE *f = fopen(WESTON_CONFIG, "r");
+    if (f) {
+        size_t n = fread(existing, 1, sizeof(existing), f);
+        fclose(f);
+        if (n == sizeof(config) - 1 && memcmp(existing, config, n) == 0) {
+            return;
+        }
+    }
+
+    f = fopen(WESTON_CONFIG, "w");
+    if (!f) return;
+    fwrite(config, 1, sizeof(config) - 1, f);
     fclose(f);
 }
 
+/*
+ * Block until the compositor's wayland-0 socket shows up in the runtime
+ * dir, driven by inotify rather than a fixed sleep. Returns 0 once the
+ * compositor accepts clients, -1 after the bounded timeout.
+ */
+static int wait_for_compositor(void) {
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    int ifd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (ifd >= 0) {
+        inotify_add_watch(ifd, RUNTIME_DIR, IN_CREATE);
+    }
+
+    int elapsed = 0;
+    while (elapsed < COMPOSITOR_WAIT_MS) {
+        if (access(WAYLAND_SOCKET, F_OK) == 0) {
+            if (ifd >= 0) close(ifd);
+            printf("[DISPLAY] Compositor ready after %d ms\n", elapsed);
+            return 0;
+        }
+
+        if (ifd >= 0) {
+            struct pollfd pfd = { .fd = ifd, .events = POLLIN, .revents = 0 };
+            if (poll(&pfd, 1, COMPOSITOR_WAIT_MS - elapsed) > 0) {
+                char buf[1024];
+                read(ifd, buf, sizeof(buf));  /* drain; the access() above decides */
+            }
+        } else {
+            usleep(100000);  /* no inotify; fall back to probing */
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        elapsed = (int)((now.tv_sec - start.tv_sec) * 1000 +
+                        (now.tv_nsec - start.tv_nsec) / 1000000);
+    }
+
+    if (ifd >= 0) close(ifd);
+    fprintf(stderr, "[DISPLAY] Compositor not ready after %d ms, starting shell anyway\n",
+        COMPOSITOR_WAIT_MS);
+    return -1;
+}
+
 static void start_weston(void) {
     const char *backend = detect_backend();
     printf("[DISPLAY] Using backend: %s\n", backend);
@@ -94,9 +153,9 @@ static void start_weston(void) {
     }
     
     printf("[DISPLAY] Weston started (PID %d)\n", g_weston_pid);
-    
-    /* Wait for Weston to initialize */
-    sleep(2);
+
+    /* Launch the shell the moment the compositor accepts clients */
+    wait_for_compositor();
 }
 
 static void start_shell(void) {
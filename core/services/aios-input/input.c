@@ -2,8 +2,8 @@
  * AI-OS Input Service
  * Handles keyboard input, hotkeys, and global shortcuts.
  * Uses libevdev for direct input device access.
- * 
- * Compile: gcc -o aios-input input.c hal.c -levdev -lpthread
+ *
+ * Compile: gcc -o aios-input input.c hal.c ipc.c -levdev -lcjson -lpthread
  */
 
 #define _GNU_SOURCE
@@ -16,17 +16,22 @@
 #include <signal.h>
 #include <pthread.h>
 #include <errno.h>
+#include <time.h>
 #include <linux/input.h>
 #include <libevdev/libevdev.h>
-#include <sys/socket.h>
-#include <sys/un.h>
+#include <cjson/cJSON.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
 
 #include "hal.h"
+#include "ipc.h"
 
 /* ==================== Configuration ==================== */
 
 #define MAX_DEVICES 8
+#define MAX_HOTKEYS 64
 #define AGENT_SOCKET "/run/aios/agent.sock"
+#define INPUT_CONFIG_PATH "/etc/aios/input.json"
 
 typedef struct {
     int ctrl;
@@ -34,12 +39,12 @@ typedef struct {
     int shift;
     int super;
     int key;
-    const char *action;
-    const char *description;
+    char action[32];
+    char description[64];
 } hotkey_t;
 
-/* Default hotkeys */
-static hotkey_t hotkeys[] = {
+/* Built-in bindings; /etc/aios/input.json overrides or extends these */
+static const hotkey_t default_hotkeys[] = {
     {0, 0, 0, 1, KEY_SPACE,    "agent_activate", "Activate AI Agent"},
     {0, 0, 0, 1, KEY_T,        "terminal",       "Open Terminal"},
     {0, 0, 0, 1, KEY_L,        "lock",           "Lock Screen"},
@@ -53,15 +58,20 @@ static hotkey_t hotkeys[] = {
     {0, 0, 0, 0, KEY_MUTE,         "volume_mute",    "Mute"},
     {0, 0, 0, 0, KEY_BRIGHTNESSUP,   "brightness_up",   "Brightness Up"},
     {0, 0, 0, 0, KEY_BRIGHTNESSDOWN, "brightness_down", "Brightness Down"},
-    {0, 0, 0, 0, 0, NULL, NULL}  /* End marker */
 };
 
+/* Flat lookup table scanned on every key press */
+static hotkey_t g_hotkeys[MAX_HOTKEYS];
+static int g_hotkey_count = 0;
+
 /* ==================== Globals ==================== */
 
 static volatile int g_running = 1;
 static int g_device_fds[MAX_DEVICES];
 static struct libevdev *g_devices[MAX_DEVICES];
+static char g_device_paths[MAX_DEVICES][32];
 static int g_device_count = 0;
+static int g_epoll_fd = -1;
 
 /* Modifier states */
 static int g_ctrl_pressed = 0;
@@ -69,27 +79,140 @@ static int g_alt_pressed = 0;
 static int g_shift_pressed = 0;
 static int g_super_pressed = 0;
 
+/* Persistent agent connection; reconnects live in libaios-ipc */
+static aios_ipc_t g_agent;
+
+/* ==================== Hotkey Table ==================== */
+
+/* Key names accepted in input.json (matched case-insensitively) */
+static const struct {
+    const char *name;
+    int code;
+} key_names[] = {
+    {"a", KEY_A}, {"b", KEY_B}, {"c", KEY_C}, {"d", KEY_D},
+    {"e", KEY_E}, {"f", KEY_F}, {"g", KEY_G}, {"h", KEY_H},
+    {"i", KEY_I}, {"j", KEY_J}, {"k", KEY_K}, {"l", KEY_L},
+    {"m", KEY_M}, {"n", KEY_N}, {"o", KEY_O}, {"p", KEY_P},
+    {"q", KEY_Q}, {"r", KEY_R}, {"s", KEY_S}, {"t", KEY_T},
+    {"u", KEY_U}, {"v", KEY_V}, {"w", KEY_W}, {"x", KEY_X},
+    {"y", KEY_Y}, {"z", KEY_Z},
+    {"0", KEY_0}, {"1", KEY_1}, {"2", KEY_2}, {"3", KEY_3},
+    {"4", KEY_4}, {"5", KEY_5}, {"6", KEY_6}, {"7", KEY_7},
+    {"8", KEY_8}, {"9", KEY_9},
+    {"f1", KEY_F1}, {"f2", KEY_F2}, {"f3", KEY_F3}, {"f4", KEY_F4},
+    {"f5", KEY_F5}, {"f6", KEY_F6}, {"f7", KEY_F7}, {"f8", KEY_F8},
+    {"f9", KEY_F9}, {"f10", KEY_F10}, {"f11", KEY_F11}, {"f12", KEY_F12},
+    {"space", KEY_SPACE}, {"enter", KEY_ENTER}, {"tab", KEY_TAB},
+    {"esc", KEY_ESC}, {"delete", KEY_DELETE}, {"print", KEY_PRINT},
+    {"volumeup", KEY_VOLUMEUP}, {"volumedown", KEY_VOLUMEDOWN},
+    {"mute", KEY_MUTE},
+    {"brightnessup", KEY_BRIGHTNESSUP}, {"brightnessdown", KEY_BRIGHTNESSDOWN},
+    {NULL, 0}
+};
+
+static int key_name_to_code(const char *name) {
+    for (int i = 0; key_names[i].name != NULL; i++) {
+        if (strcasecmp(key_names[i].name, name) == 0) {
+            return key_names[i].code;
+        }
+    }
+    return 0;
+}
+
+/* Add a binding; a config entry with the same chord overrides a default */
+static void hotkey_add(const hotkey_t *hk) {
+    for (int i = 0; i < g_hotkey_count; i++) {
+        if (g_hotkeys[i].key == hk->key &&
+            g_hotkeys[i].ctrl == hk->ctrl &&
+            g_hotkeys[i].alt == hk->alt &&
+            g_hotkeys[i].shift == hk->shift &&
+            g_hotkeys[i].super == hk->super) {
+            g_hotkeys[i] = *hk;
+            return;
+        }
+    }
+    if (g_hotkey_count < MAX_HOTKEYS) {
+        g_hotkeys[g_hotkey_count++] = *hk;
+    }
+}
+
+/* Build the lookup table: built-in defaults first, then input.json */
+static void load_hotkeys(void) {
+    for (size_t i = 0; i < sizeof(default_hotkeys) / sizeof(default_hotkeys[0]); i++) {
+        g_hotkeys[g_hotkey_count++] = default_hotkeys[i];
+    }
+
+    FILE *f = fopen(INPUT_CONFIG_PATH, "r");
+    if (!f) return;
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    char *buf = malloc(size + 1);
+    if (buf) {
+        fread(buf, 1, size, f);
+        buf[size] = '\0';
+
+        cJSON *json = cJSON_Parse(buf);
+        if (json) {
+            cJSON *list = cJSON_GetObjectItem(json, "hotkeys");
+            cJSON *entry;
+            cJSON_ArrayForEach(entry, list) {
+                cJSON *key = cJSON_GetObjectItem(entry, "key");
+                cJSON *action = cJSON_GetObjectItem(entry, "action");
+                if (!key || !key->valuestring || !action || !action->valuestring) continue;
+
+                hotkey_t hk = {0};
+                hk.key = key_name_to_code(key->valuestring);
+                if (hk.key == 0) {
+                    fprintf(stderr, "[INPUT] Unknown key in config: %s\n", key->valuestring);
+                    continue;
+                }
+
+                cJSON *mods = cJSON_GetObjectItem(entry, "modifiers");
+                cJSON *mod;
+                cJSON_ArrayForEach(mod, mods) {
+                    if (!mod->valuestring) continue;
+                    if (strcmp(mod->valuestring, "ctrl") == 0) hk.ctrl = 1;
+                    else if (strcmp(mod->valuestring, "alt") == 0) hk.alt = 1;
+                    else if (strcmp(mod->valuestring, "shift") == 0) hk.shift = 1;
+                    else if (strcmp(mod->valuestring, "super") == 0) hk.super = 1;
+                }
+
+                strncpy(hk.action, action->valuestring, sizeof(hk.action) - 1);
+                cJSON *desc = cJSON_GetObjectItem(entry, "description");
+                if (desc && desc->valuestring) {
+                    strncpy(hk.description, desc->valuestring, sizeof(hk.description) - 1);
+                }
+
+                hotkey_add(&hk);
+            }
+            cJSON_Delete(json);
+        }
+        free(buf);
+    }
+    fclose(f);
+}
+
 /* ==================== Actions ==================== */
 
+/* Fork+exec without going through /bin/sh; SIGCHLD is ignored so the
+ * child is reaped by the kernel */
+static void spawn(const char *file, const char *arg) {
+    if (fork() == 0) {
+        execlp(file, file, arg, (char *)NULL);
+        exit(1);
+    }
+}
+
 static void execute_action(const char *action) {
     printf("[INPUT] Executing action: %s\n", action);
-    
+
     if (strcmp(action, "agent_activate") == 0) {
-        /* Send activation to agent */
-        int sock = socket(AF_UNIX, SOCK_STREAM, 0);
-        if (sock >= 0) {
-            struct sockaddr_un addr = {0};
-            addr.sun_family = AF_UNIX;
-            strcpy(addr.sun_path, AGENT_SOCKET);
-            
-            if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
-                const char *msg = "{\"cmd\":\"activate\"}";
-                uint32_t len = htonl(strlen(msg));
-                send(sock, &len, 4, 0);
-                send(sock, msg, strlen(msg), 0);
-            }
-            close(sock);
-        }
+        char response[256];
+        aios_ipc_request(&g_agent, "{\"cmd\":\"activate\"}",
+                         response, sizeof(response));
     }
     else if (strcmp(action, "terminal") == 0) {
         if (fork() == 0) {
@@ -99,12 +222,12 @@ static void execute_action(const char *action) {
         }
     }
     else if (strcmp(action, "lock") == 0) {
-        system("loginctl lock-session");
+        spawn("loginctl", "lock-session");
     }
     else if (strcmp(action, "screenshot") == 0) {
-        char cmd[256];
-        snprintf(cmd, sizeof(cmd), "grim /tmp/screenshot-%ld.png &", time(NULL));
-        system(cmd);
+        char path[64];
+        snprintf(path, sizeof(path), "/tmp/screenshot-%ld.png", time(NULL));
+        spawn("grim", path);
     }
     else if (strcmp(action, "volume_up") == 0) {
         int vol = hal_volume_get();
@@ -134,13 +257,13 @@ static void execute_action(const char *action) {
 /* ==================== Input Handling ==================== */
 
 static void check_hotkey(int key) {
-    for (int i = 0; hotkeys[i].action != NULL; i++) {
-        if (hotkeys[i].key == key &&
-            hotkeys[i].ctrl == g_ctrl_pressed &&
-            hotkeys[i].alt == g_alt_pressed &&
-            hotkeys[i].shift == g_shift_pressed &&
-            hotkeys[i].super == g_super_pressed) {
-            execute_action(hotkeys[i].action);
+    for (int i = 0; i < g_hotkey_count; i++) {
+        if (g_hotkeys[i].key == key &&
+            g_hotkeys[i].ctrl == g_ctrl_pressed &&
+            g_hotkeys[i].alt == g_alt_pressed &&
+            g_hotkeys[i].shift == g_shift_pressed &&
+            g_hotkeys[i].super == g_super_pressed) {
+            execute_action(g_hotkeys[i].action);
             return;
         }
     }
@@ -199,43 +322,113 @@ static int is_keyboard(const char *path) {
     return is_kbd;
 }
 
+/* Probe a device node and register it if it is a keyboard.
+ * Returns 0 on success, -1 if skipped or failed. */
+static int add_device(const char *path) {
+    if (g_device_count >= MAX_DEVICES) return -1;
+
+    /* Already tracked? (inotify can fire for nodes we found at startup) */
+    for (int i = 0; i < g_device_count; i++) {
+        if (strcmp(g_device_paths[i], path) == 0) return -1;
+    }
+
+    if (!is_keyboard(path)) return -1;
+
+    int fd = open(path, O_RDONLY | O_NONBLOCK);
+    if (fd < 0) return -1;
+
+    struct libevdev *dev = NULL;
+    if (libevdev_new_from_fd(fd, &dev) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    /* Grab device for exclusive input */
+    libevdev_grab(dev, LIBEVDEV_GRAB);
+
+    struct epoll_event ev = {0};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(g_epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        libevdev_free(dev);
+        close(fd);
+        return -1;
+    }
+
+    g_device_fds[g_device_count] = fd;
+    g_devices[g_device_count] = dev;
+    snprintf(g_device_paths[g_device_count], sizeof(g_device_paths[0]), "%s", path);
+    g_device_count++;
+
+    printf("[INPUT] Found keyboard: %s (%s)\n",
+        libevdev_get_name(dev), path);
+    return 0;
+}
+
+/* Unregister and release the device in slot i */
+static void remove_device(int i) {
+    printf("[INPUT] Removed keyboard: %s\n", g_device_paths[i]);
+
+    epoll_ctl(g_epoll_fd, EPOLL_CTL_DEL, g_device_fds[i], NULL);
+    libevdev_free(g_devices[i]);
+    close(g_device_fds[i]);
+
+    /* Compact the arrays */
+    g_device_count--;
+    for (int j = i; j < g_device_count; j++) {
+        g_device_fds[j] = g_device_fds[j + 1];
+        g_devices[j] = g_devices[j + 1];
+        strcpy(g_device_paths[j], g_device_paths[j + 1]);
+    }
+}
+
 static int discover_devices(void) {
     DIR *dir = opendir("/dev/input");
     if (!dir) return -1;
-    
+
     struct dirent *entry;
     while ((entry = readdir(dir)) != NULL && g_device_count < MAX_DEVICES) {
         if (strncmp(entry->d_name, "event", 5) != 0) continue;
-        
+
         char path[256];
         snprintf(path, sizeof(path), "/dev/input/%s", entry->d_name);
-        
-        if (!is_keyboard(path)) continue;
-        
-        int fd = open(path, O_RDONLY | O_NONBLOCK);
-        if (fd < 0) continue;
-        
-        struct libevdev *dev = NULL;
-        if (libevdev_new_from_fd(fd, &dev) < 0) {
-            close(fd);
-            continue;
-        }
-        
-        /* Grab device for exclusive input */
-        libevdev_grab(dev, LIBEVDEV_GRAB);
-        
-        g_device_fds[g_device_count] = fd;
-        g_devices[g_device_count] = dev;
-        g_device_count++;
-        
-        printf("[INPUT] Found keyboard: %s (%s)\n", 
-            libevdev_get_name(dev), path);
+        add_device(path);
     }
-    
+
     closedir(dir);
     return g_device_count;
 }
 
+/* Handle a batch of inotify events on /dev/input. New nodes are probed
+ * on IN_ATTRIB too, since udev fixes permissions after IN_CREATE. */
+static void handle_hotplug(int inotify_fd) {
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    ssize_t len = read(inotify_fd, buf, sizeof(buf));
+    if (len <= 0) return;
+
+    for (char *p = buf; p < buf + len; ) {
+        struct inotify_event *ev = (struct inotify_event *)p;
+        p += sizeof(struct inotify_event) + ev->len;
+
+        if (ev->len == 0 || strncmp(ev->name, "event", 5) != 0) continue;
+
+        char path[256];
+        snprintf(path, sizeof(path), "/dev/input/%s", ev->name);
+
+        if (ev->mask & IN_DELETE) {
+            for (int i = 0; i < g_device_count; i++) {
+                if (strcmp(g_device_paths[i], path) == 0) {
+                    remove_device(i);
+                    break;
+                }
+            }
+        } else {
+            add_device(path);
+        }
+    }
+}
+
 /* ==================== Main Loop ==================== */
 
 static void signal_handler(int sig) {
@@ -247,52 +440,83 @@ int main(int argc, char *argv[]) {
     
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
-    
-    if (discover_devices() <= 0) {
-        fprintf(stderr, "[INPUT] No input devices found\n");
+    signal(SIGCHLD, SIG_IGN);  /* spawned actions are never waited on */
+
+    aios_ipc_init(&g_agent, AGENT_SOCKET);
+    load_hotkeys();
+    printf("[INPUT] %d hotkeys active\n", g_hotkey_count);
+
+    g_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (g_epoll_fd < 0) {
+        fprintf(stderr, "[INPUT] Failed to create epoll instance\n");
         return 1;
     }
-    
+
+    /* Watch /dev/input so keyboards plugged in later are picked up */
+    int inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd >= 0) {
+        inotify_add_watch(inotify_fd, "/dev/input",
+            IN_CREATE | IN_ATTRIB | IN_DELETE);
+
+        struct epoll_event ev = {0};
+        ev.events = EPOLLIN;
+        ev.data.fd = inotify_fd;
+        epoll_ctl(g_epoll_fd, EPOLL_CTL_ADD, inotify_fd, &ev);
+    }
+
+    if (discover_devices() <= 0) {
+        fprintf(stderr, "[INPUT] No keyboards found, waiting for hotplug\n");
+    }
+
     printf("[INPUT] Monitoring %d keyboard(s)\n", g_device_count);
-    
+
     while (g_running) {
-        fd_set fds;
-        FD_ZERO(&fds);
-        
-        int max_fd = 0;
-        for (int i = 0; i < g_device_count; i++) {
-            FD_SET(g_device_fds[i], &fds);
-            if (g_device_fds[i] > max_fd) max_fd = g_device_fds[i];
-        }
-        
-        struct timeval tv = {1, 0};  /* 1 second timeout */
-        int ret = select(max_fd + 1, &fds, NULL, NULL, &tv);
-        
+        struct epoll_event events[MAX_DEVICES + 1];
+
+        /* Block until input or hotplug; signals wake us via EINTR */
+        int ret = epoll_wait(g_epoll_fd, events, MAX_DEVICES + 1, -1);
         if (ret <= 0) continue;
-        
-        for (int i = 0; i < g_device_count; i++) {
-            if (!FD_ISSET(g_device_fds[i], &fds)) continue;
-            
+
+        for (int n = 0; n < ret; n++) {
+            if (inotify_fd >= 0 && events[n].data.fd == inotify_fd) {
+                handle_hotplug(inotify_fd);
+                continue;
+            }
+
+            int i;
+            for (i = 0; i < g_device_count; i++) {
+                if (g_device_fds[i] == events[n].data.fd) break;
+            }
+            if (i >= g_device_count) continue;  /* removed this batch */
+
             struct input_event ev;
-            int rc = libevdev_next_event(g_devices[i], 
+            int rc = libevdev_next_event(g_devices[i],
                 LIBEVDEV_READ_FLAG_NORMAL, &ev);
-            
+
             while (rc == LIBEVDEV_READ_STATUS_SUCCESS ||
                    rc == LIBEVDEV_READ_STATUS_SYNC) {
                 process_event(&ev);
                 rc = libevdev_next_event(g_devices[i],
                     LIBEVDEV_READ_FLAG_NORMAL, &ev);
             }
+
+            /* Unplugged mid-read (races ahead of the inotify event) */
+            if (rc == -ENODEV || (events[n].events & (EPOLLERR | EPOLLHUP))) {
+                remove_device(i);
+            }
         }
     }
-    
+
     /* Cleanup */
     for (int i = 0; i < g_device_count; i++) {
         libevdev_grab(g_devices[i], LIBEVDEV_UNGRAB);
         libevdev_free(g_devices[i]);
         close(g_device_fds[i]);
     }
-    
+    if (inotify_fd >= 0) close(inotify_fd);
+    close(g_epoll_fd);
+    aios_ipc_close(&g_agent);
+
     printf("[INPUT] Input service stopped\n");
     return 0;
 }
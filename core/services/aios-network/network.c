@@ -2,7 +2,7 @@
  * AI-OS Network Manager
  * WiFi, Bluetooth, and network management in C.
  * 
- * Compile: gcc -o aios-network network.c -lpthread
+ * Compile: gcc -o aios-network network.c -I../../hal -I../../ipc -L../../hal -laios-hal -laios-ipc -lpthread
  */
 
 #define _GNU_SOURCE
@@ -13,6 +13,7 @@
 #include <signal.h>
 #include <pthread.h>
 #include <errno.h>
+#include <time.h>
 #include <dirent.h>
 #include <sys/socket.h>
 #include <sys/un.h>
@@ -20,6 +21,9 @@
 #include <net/if.h>
 #include <arpa/inet.h>
 
+#include "hal.h"
+#include "ipc.h"
+
 #define SOCKET_PATH "/run/aios/network.sock"
 
 /* ==================== Types ==================== */
@@ -42,7 +46,7 @@ typedef struct {
 /* ==================== Globals ==================== */
 
 static volatile int g_running = 1;
-static int g_server_fd = -1;
+static aios_ipc_server_t g_server;
 
 /* ==================== Interface Functions ==================== */
 
@@ -113,24 +117,16 @@ static int get_interfaces(interface_t *ifaces, int max_count) {
 /* ==================== WiFi Functions ==================== */
 
 static int wifi_enabled(void) {
-    FILE *fp = popen("nmcli radio wifi 2>/dev/null", "r");
-    if (!fp) return -1;
-    
-    char buf[32];
-    fgets(buf, sizeof(buf), fp);
-    pclose(fp);
-    
-    return strstr(buf, "enabled") ? 1 : 0;
+    /* rfkill-backed HAL call; no subprocess */
+    return hal_wifi_enabled();
 }
 
 static int wifi_set_enabled(int enabled) {
-    char cmd[64];
-    snprintf(cmd, sizeof(cmd), "nmcli radio wifi %s >/dev/null 2>&1", 
-             enabled ? "on" : "off");
-    return system(cmd) == 0 ? 0 : -1;
+    return hal_wifi_set(enabled != 0);
 }
 
-static int wifi_scan(wifi_network_t *networks, int max_count) {
+/* Blocking nmcli scan; only the scanner thread calls this */
+static int wifi_scan_nmcli(wifi_network_t *networks, int max_count) {
     /* Trigger scan */
     system("nmcli device wifi rescan 2>/dev/null");
     usleep(500000);
@@ -181,178 +177,332 @@ static int wifi_disconnect(void) {
     return system("nmcli device disconnect wlan0 >/dev/null 2>&1") == 0 ? 0 : -1;
 }
 
-/* ==================== Bluetooth Functions ==================== */
+/* ==================== Scan Cache ==================== */
 
-static int bluetooth_enabled(void) {
-    FILE *fp = popen("bluetoothctl show 2>/dev/null | grep 'Powered: yes'", "r");
-    if (!fp) return -1;
-    
-    char buf[64];
-    int enabled = (fgets(buf, sizeof(buf), fp) != NULL);
-    pclose(fp);
-    
-    return enabled;
+/*
+ * A background thread keeps a cached scan table so wifi_scan requests
+ * are served instantly. The refresh interval adapts: fast while someone
+ * recently asked (the UI's network panel polls or subscribes), slow when
+ * nobody is looking. Subscribers get pushed deltas after each refresh;
+ * a subscribed connection should be dedicated to the subscription so
+ * pushes don't interleave with request responses.
+ */
+
+#define SCAN_MAX_NETWORKS 32
+#define SCAN_INTERVAL_FAST 10     /* seconds, while there is interest */
+#define SCAN_INTERVAL_SLOW 60
+#define SCAN_BOOST_SECS 120       /* stay fast this long after last interest */
+#define SCAN_SIGNAL_DELTA 5       /* ignore smaller signal changes */
+#define MAX_SUBSCRIBERS 8
+
+static wifi_network_t g_scan_table[SCAN_MAX_NETWORKS];
+static int g_scan_count = 0;
+static time_t g_scan_time = 0;      /* completion time of the last scan */
+static time_t g_scan_interest = 0;  /* last scan request or subscribe */
+static pthread_mutex_t g_scan_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_scan_wake = PTHREAD_COND_INITIALIZER;
+static pthread_t g_scan_thread;
+
+static int g_subscribers[MAX_SUBSCRIBERS];  /* client fds, -1 = free slot */
+static pthread_mutex_t g_sub_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int format_network(char *ptr, const wifi_network_t *net) {
+    return sprintf(ptr,
+        "{\"ssid\":\"%s\",\"signal\":%d,\"security\":\"%s\",\"connected\":%s}",
+        net->ssid, net->signal, net->security,
+        net->connected ? "true" : "false");
 }
 
-static int bluetooth_set_enabled(int enabled) {
-    char cmd[64];
-    snprintf(cmd, sizeof(cmd), "bluetoothctl power %s >/dev/null 2>&1",
-             enabled ? "on" : "off");
-    return system(cmd) == 0 ? 0 : -1;
+/* Serialize the cached table; caller holds g_scan_mutex */
+static int format_scan_table(char *ptr) {
+    char *start = ptr;
+    for (int i = 0; i < g_scan_count; i++) {
+        if (i > 0) ptr += sprintf(ptr, ",");
+        ptr += format_network(ptr, &g_scan_table[i]);
+    }
+    return ptr - start;
 }
 
-/* ==================== IPC Server ==================== */
+static const wifi_network_t *find_network(const wifi_network_t *table,
+                                          int count, const char *ssid) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(table[i].ssid, ssid) == 0) return &table[i];
+    }
+    return NULL;
+}
 
-static void handle_request(int client_fd, const char *msg) {
-    char response[8192] = "{\"status\":\"ok\"}";
-    
-    if (strstr(msg, "\"cmd\":\"interfaces\"")) {
-        interface_t ifaces[16];
-        int count = get_interfaces(ifaces, 16);
-        
-        char *ptr = response;
-        ptr += sprintf(ptr, "{\"status\":\"ok\",\"interfaces\":[");
-        
-        for (int i = 0; i < count; i++) {
-            if (i > 0) ptr += sprintf(ptr, ",");
-            ptr += sprintf(ptr, 
-                "{\"name\":\"%s\",\"type\":\"%s\",\"state\":\"%s\",\"mac\":\"%s\",\"ip\":\"%s\"}",
-                ifaces[i].name, ifaces[i].type, ifaces[i].state, 
-                ifaces[i].mac, ifaces[i].ip);
-        }
-        ptr += sprintf(ptr, "]}");
+/*
+ * Diff a fresh scan against the cached table into a push event with
+ * added/removed/changed lists; caller holds g_scan_mutex.
+ * Returns 1 if anything changed, 0 if the tables match.
+ */
+static int diff_scan_tables(const wifi_network_t *fresh, int count,
+                            char *buf, size_t size) {
+    (void)size;  /* 8K buffer fits SCAN_MAX_NETWORKS worst case */
+    int changes = 0;
+    char *ptr = buf;
+    ptr += sprintf(ptr, "{\"event\":\"wifi_scan\",\"added\":[");
+
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        if (find_network(g_scan_table, g_scan_count, fresh[i].ssid)) continue;
+        if (n++ > 0) ptr += sprintf(ptr, ",");
+        ptr += format_network(ptr, &fresh[i]);
+        changes++;
     }
-    else if (strstr(msg, "\"cmd\":\"wifi_status\"")) {
-        int enabled = wifi_enabled();
-        snprintf(response, sizeof(response), 
-            "{\"status\":\"ok\",\"wifi_enabled\":%s}", 
-            enabled ? "true" : "false");
+
+    ptr += sprintf(ptr, "],\"removed\":[");
+    n = 0;
+    for (int i = 0; i < g_scan_count; i++) {
+        if (find_network(fresh, count, g_scan_table[i].ssid)) continue;
+        if (n++ > 0) ptr += sprintf(ptr, ",");
+        ptr += sprintf(ptr, "\"%s\"", g_scan_table[i].ssid);
+        changes++;
     }
-    else if (strstr(msg, "\"cmd\":\"wifi_enable\"")) {
-        int enable = strstr(msg, "\"enable\":true") != NULL;
-        wifi_set_enabled(enable);
-        snprintf(response, sizeof(response), 
-            "{\"status\":\"ok\",\"wifi_enabled\":%s}", enable ? "true" : "false");
+
+    ptr += sprintf(ptr, "],\"changed\":[");
+    n = 0;
+    for (int i = 0; i < count; i++) {
+        const wifi_network_t *old = find_network(g_scan_table, g_scan_count,
+                                                 fresh[i].ssid);
+        if (!old) continue;
+        if (abs(old->signal - fresh[i].signal) < SCAN_SIGNAL_DELTA &&
+            old->connected == fresh[i].connected &&
+            strcmp(old->security, fresh[i].security) == 0) continue;
+        if (n++ > 0) ptr += sprintf(ptr, ",");
+        ptr += format_network(ptr, &fresh[i]);
+        changes++;
     }
-    else if (strstr(msg, "\"cmd\":\"wifi_scan\"")) {
-        wifi_network_t networks[32];
-        int count = wifi_scan(networks, 32);
-        
-        char *ptr = response;
-        ptr += sprintf(ptr, "{\"status\":\"ok\",\"networks\":[");
-        
-        for (int i = 0; i < count; i++) {
-            if (i > 0) ptr += sprintf(ptr, ",");
-            ptr += sprintf(ptr, 
-                "{\"ssid\":\"%s\",\"signal\":%d,\"security\":\"%s\",\"connected\":%s}",
-                networks[i].ssid, networks[i].signal, networks[i].security,
-                networks[i].connected ? "true" : "false");
+
+    sprintf(ptr, "]}");
+    return changes > 0;
+}
+
+static void subscriber_add(int fd) {
+    pthread_mutex_lock(&g_sub_mutex);
+    for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
+        if (g_subscribers[i] == fd) {
+            pthread_mutex_unlock(&g_sub_mutex);
+            return;
         }
-        ptr += sprintf(ptr, "]}");
     }
-    else if (strstr(msg, "\"cmd\":\"wifi_connect\"")) {
-        char ssid[64] = "", password[128] = "";
-        char *p;
-        
-        if ((p = strstr(msg, "\"ssid\":\""))) {
-            sscanf(p, "\"ssid\":\"%63[^\"]\"", ssid);
-        }
-        if ((p = strstr(msg, "\"password\":\""))) {
-            sscanf(p, "\"password\":\"%127[^\"]\"", password);
+    for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
+        if (g_subscribers[i] < 0) {
+            g_subscribers[i] = fd;
+            break;
         }
-        
-        int result = wifi_connect(ssid, password);
-        snprintf(response, sizeof(response), 
-            "{\"status\":\"%s\",\"message\":\"%s\"}", 
-            result == 0 ? "ok" : "error",
-            result == 0 ? "Connected" : "Connection failed");
-    }
-    else if (strstr(msg, "\"cmd\":\"wifi_disconnect\"")) {
-        wifi_disconnect();
     }
-    else if (strstr(msg, "\"cmd\":\"bluetooth_status\"")) {
-        int enabled = bluetooth_enabled();
-        snprintf(response, sizeof(response), 
-            "{\"status\":\"ok\",\"bluetooth_enabled\":%s}", 
-            enabled ? "true" : "false");
+    pthread_mutex_unlock(&g_sub_mutex);
+}
+
+static void subscriber_remove(int fd) {
+    pthread_mutex_lock(&g_sub_mutex);
+    for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
+        if (g_subscribers[i] == fd) g_subscribers[i] = -1;
     }
-    else if (strstr(msg, "\"cmd\":\"bluetooth_enable\"")) {
-        int enable = strstr(msg, "\"enable\":true") != NULL;
-        bluetooth_set_enabled(enable);
+    pthread_mutex_unlock(&g_sub_mutex);
+}
+
+static void push_to_subscribers(const char *msg) {
+    pthread_mutex_lock(&g_sub_mutex);
+    for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
+        if (g_subscribers[i] < 0) continue;
+        if (aios_ipc_send_frame(g_subscribers[i], msg, strlen(msg)) < 0) {
+            g_subscribers[i] = -1;  /* the client thread closes the fd */
+        }
     }
-    
-    /* Send response */
-    uint32_t len = htonl(strlen(response));
-    send(client_fd, &len, 4, 0);
-    send(client_fd, response, strlen(response), 0);
+    pthread_mutex_unlock(&g_sub_mutex);
 }
 
-static void *client_handler(void *arg) {
-    int client_fd = *(int *)arg;
-    free(arg);
-    
-    while (1) {
-        uint32_t length;
-        if (recv(client_fd, &length, 4, 0) != 4) break;
-        length = ntohl(length);
-        
-        if (length > 4096) break;
-        
-        char *msg = malloc(length + 1);
-        if (!msg) break;
-        
-        if (recv(client_fd, msg, length, 0) != length) {
-            free(msg);
-            break;
+static void *scanner_thread(void *arg) {
+    (void)arg;
+
+    while (g_running) {
+        wifi_network_t fresh[SCAN_MAX_NETWORKS];
+        int count = wifi_scan_nmcli(fresh, SCAN_MAX_NETWORKS);
+
+        char deltas[8192];
+        int changed;
+
+        pthread_mutex_lock(&g_scan_mutex);
+        changed = diff_scan_tables(fresh, count, deltas, sizeof(deltas));
+        memcpy(g_scan_table, fresh, sizeof(wifi_network_t) * count);
+        g_scan_count = count;
+        g_scan_time = time(NULL);
+        int fast = (g_scan_time - g_scan_interest) < SCAN_BOOST_SECS;
+        pthread_mutex_unlock(&g_scan_mutex);
+
+        if (changed) {
+            push_to_subscribers(deltas);
         }
-        msg[length] = '\0';
-        
-        handle_request(client_fd, msg);
-        free(msg);
+
+        /* Sleep until the next refresh; a stale scan request wakes us */
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += fast ? SCAN_INTERVAL_FAST : SCAN_INTERVAL_SLOW;
+
+        pthread_mutex_lock(&g_scan_mutex);
+        pthread_cond_timedwait(&g_scan_wake, &g_scan_mutex, &ts);
+        pthread_mutex_unlock(&g_scan_mutex);
     }
-    
-    close(client_fd);
     return NULL;
 }
 
-static int run_server(void) {
-    g_server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (g_server_fd < 0) {
-        perror("socket");
-        return -1;
+/* ==================== Bluetooth Functions ==================== */
+
+static int bluetooth_enabled(void) {
+    return hal_bluetooth_enabled();
+}
+
+static int bluetooth_set_enabled(int enabled) {
+    return hal_bluetooth_set(enabled != 0);
+}
+
+/* ==================== IPC Server ==================== */
+
+static void cmd_interfaces(int client_fd, const char *msg,
+                           char *response, size_t response_size) {
+    (void)client_fd; (void)msg; (void)response_size;
+    interface_t ifaces[16];
+    int count = get_interfaces(ifaces, 16);
+
+    char *ptr = response;
+    ptr += sprintf(ptr, "{\"status\":\"ok\",\"interfaces\":[");
+
+    for (int i = 0; i < count; i++) {
+        if (i > 0) ptr += sprintf(ptr, ",");
+        ptr += sprintf(ptr,
+            "{\"name\":\"%s\",\"type\":\"%s\",\"state\":\"%s\",\"mac\":\"%s\",\"ip\":\"%s\"}",
+            ifaces[i].name, ifaces[i].type, ifaces[i].state,
+            ifaces[i].mac, ifaces[i].ip);
     }
-    
-    struct sockaddr_un addr = {0};
-    addr.sun_family = AF_UNIX;
-    strncpy(addr.sun_path, SOCKET_PATH, sizeof(addr.sun_path) - 1);
-    
-    unlink(SOCKET_PATH);
-    
-    if (bind(g_server_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-        perror("bind");
-        return -1;
+    sprintf(ptr, "]}");
+}
+
+static void cmd_wifi_status(int client_fd, const char *msg,
+                            char *response, size_t response_size) {
+    (void)client_fd; (void)msg;
+    int enabled = wifi_enabled();
+    snprintf(response, response_size,
+        "{\"status\":\"ok\",\"wifi_enabled\":%s}",
+        enabled ? "true" : "false");
+}
+
+static void cmd_wifi_enable(int client_fd, const char *msg,
+                            char *response, size_t response_size) {
+    (void)client_fd;
+    int enable = strstr(msg, "\"enable\":true") != NULL;
+    wifi_set_enabled(enable);
+    snprintf(response, response_size,
+        "{\"status\":\"ok\",\"wifi_enabled\":%s}", enable ? "true" : "false");
+}
+
+static void cmd_wifi_scan(int client_fd, const char *msg,
+                          char *response, size_t response_size) {
+    (void)client_fd; (void)msg; (void)response_size;
+    /* Served from the cache; age says how old the table is */
+    pthread_mutex_lock(&g_scan_mutex);
+    g_scan_interest = time(NULL);
+    int age = g_scan_time ? (int)(g_scan_interest - g_scan_time) : -1;
+
+    char *ptr = response;
+    ptr += sprintf(ptr, "{\"status\":\"ok\",\"age\":%d,\"networks\":[", age);
+    ptr += format_scan_table(ptr);
+    sprintf(ptr, "]}");
+
+    /* Kick the scanner if the table is stale or missing */
+    if (age < 0 || age > SCAN_INTERVAL_FAST) {
+        pthread_cond_signal(&g_scan_wake);
     }
-    
-    chmod(SOCKET_PATH, 0666);
-    listen(g_server_fd, 5);
-    
-    printf("[NETWORK] Listening on %s\n", SOCKET_PATH);
-    
-    while (g_running) {
-        int *client = malloc(sizeof(int));
-        *client = accept(g_server_fd, NULL, NULL);
-        
-        if (*client < 0) {
-            free(client);
-            continue;
-        }
-        
-        pthread_t thread;
-        pthread_create(&thread, NULL, client_handler, client);
-        pthread_detach(thread);
+    pthread_mutex_unlock(&g_scan_mutex);
+}
+
+static void cmd_wifi_subscribe(int client_fd, const char *msg,
+                               char *response, size_t response_size) {
+    (void)msg; (void)response_size;
+    subscriber_add(client_fd);
+
+    pthread_mutex_lock(&g_scan_mutex);
+    g_scan_interest = time(NULL);
+    int age = g_scan_time ? (int)(g_scan_interest - g_scan_time) : -1;
+
+    char *ptr = response;
+    ptr += sprintf(ptr,
+        "{\"status\":\"ok\",\"subscribed\":true,\"age\":%d,\"networks\":[", age);
+    ptr += format_scan_table(ptr);
+    sprintf(ptr, "]}");
+
+    pthread_cond_signal(&g_scan_wake);
+    pthread_mutex_unlock(&g_scan_mutex);
+}
+
+static void cmd_wifi_unsubscribe(int client_fd, const char *msg,
+                                 char *response, size_t response_size) {
+    (void)msg;
+    subscriber_remove(client_fd);
+    snprintf(response, response_size,
+        "{\"status\":\"ok\",\"subscribed\":false}");
+}
+
+static void cmd_wifi_connect(int client_fd, const char *msg,
+                             char *response, size_t response_size) {
+    (void)client_fd;
+    char ssid[64] = "", password[128] = "";
+    const char *p;
+
+    if ((p = strstr(msg, "\"ssid\":\""))) {
+        sscanf(p, "\"ssid\":\"%63[^\"]\"", ssid);
     }
-    
-    return 0;
+    if ((p = strstr(msg, "\"password\":\""))) {
+        sscanf(p, "\"password\":\"%127[^\"]\"", password);
+    }
+
+    int result = wifi_connect(ssid, password);
+    snprintf(response, response_size,
+        "{\"status\":\"%s\",\"message\":\"%s\"}",
+        result == 0 ? "ok" : "error",
+        result == 0 ? "Connected" : "Connection failed");
+}
+
+static void cmd_wifi_disconnect(int client_fd, const char *msg,
+                                char *response, size_t response_size) {
+    (void)client_fd; (void)msg; (void)response; (void)response_size;
+    wifi_disconnect();
+}
+
+static void cmd_bluetooth_status(int client_fd, const char *msg,
+                                 char *response, size_t response_size) {
+    (void)client_fd; (void)msg;
+    int enabled = bluetooth_enabled();
+    snprintf(response, response_size,
+        "{\"status\":\"ok\",\"bluetooth_enabled\":%s}",
+        enabled ? "true" : "false");
+}
+
+static void cmd_bluetooth_enable(int client_fd, const char *msg,
+                                 char *response, size_t response_size) {
+    (void)client_fd; (void)response; (void)response_size;
+    int enable = strstr(msg, "\"enable\":true") != NULL;
+    bluetooth_set_enabled(enable);
+}
+
+static const aios_ipc_cmd_t g_commands[] = {
+    {"interfaces",       cmd_interfaces},
+    {"wifi_status",      cmd_wifi_status},
+    {"wifi_enable",      cmd_wifi_enable},
+    {"wifi_scan",        cmd_wifi_scan},
+    {"wifi_subscribe",   cmd_wifi_subscribe},
+    {"wifi_unsubscribe", cmd_wifi_unsubscribe},
+    {"wifi_connect",     cmd_wifi_connect},
+    {"wifi_disconnect",  cmd_wifi_disconnect},
+    {"bluetooth_status", cmd_bluetooth_status},
+    {"bluetooth_enable", cmd_bluetooth_enable},
+    {NULL, NULL}
+};
+
+/* Dead subscribers drop out when their connection goes away */
+static void on_client_disconnect(int client_fd) {
+    subscriber_remove(client_fd);
 }
 
 /* ==================== Main ==================== */
@@ -368,14 +518,26 @@ int main(int argc, char *argv[]) {
     signal(SIGTERM, signal_handler);
     
     mkdir("/run/aios", 0755);
-    
-    run_server();
-    
-    if (g_server_fd >= 0) {
-        close(g_server_fd);
-        unlink(SOCKET_PATH);
+
+    for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
+        g_subscribers[i] = -1;
     }
-    
+    pthread_create(&g_scan_thread, NULL, scanner_thread, NULL);
+
+    if (aios_ipc_server_init(&g_server, SOCKET_PATH, g_commands) < 0) {
+        perror("aios_ipc_server_init");
+        return 1;
+    }
+    g_server.on_disconnect = on_client_disconnect;
+
+    printf("[NETWORK] Listening on %s\n", SOCKET_PATH);
+    aios_ipc_server_run(&g_server, &g_running);
+
+    pthread_cond_signal(&g_scan_wake);
+    pthread_join(g_scan_thread, NULL);
+
+    aios_ipc_server_close(&g_server);
+
     printf("[NETWORK] Network manager stopped\n");
     return 0;
 }
@@ -2,7 +2,7 @@
  * AI-OS Notification Daemon
  * Desktop notification service in C.
  * 
- * Compile: gcc -o aios-notify notify.c -lpthread
+ * Compile: gcc -o aios-notify notify.c -I../../ipc -laios-ipc -lpthread
  */
 
 #define _GNU_SOURCE
@@ -12,11 +12,15 @@
 #include <unistd.h>
 #include <signal.h>
 #include <pthread.h>
+#include <stdint.h>
 #include <time.h>
 #include <errno.h>
 #include <sys/socket.h>
+#include <sys/timerfd.h>
 #include <sys/un.h>
 
+#include "ipc.h"
+
 #define SOCKET_PATH "/run/aios/notify.sock"
 #define MAX_NOTIFICATIONS 100
 #define MAX_SUMMARY_LEN 256
@@ -31,7 +35,7 @@ typedef enum {
 } urgency_t;
 
 typedef struct {
-    int id;
+    int id;             /* 0 = free slot */
     char app_name[64];
     char summary[MAX_SUMMARY_LEN];
     char body[MAX_BODY_LEN];
@@ -39,41 +43,192 @@ typedef struct {
     int timeout;        /* ms, -1 for persistent */
     time_t timestamp;
     int read;
+
+    /* Intrusive links, all indices into g_notifications (-1 = end) */
+    int64_t deadline;   /* monotonic ms when this expires, 0 = never */
+    int hash_next;      /* id hash chain */
+    int wheel_prev;     /* expiry wheel bucket list; wheel_next doubles */
+    int wheel_next;     /* as the freelist link while the slot is free  */
 } notification_t;
 
 /* ==================== Globals ==================== */
 
+#define HASH_BUCKETS 64
+#define WHEEL_BUCKETS 64
+#define WHEEL_TICK_MS 250
+
 static volatile int g_running = 1;
-static int g_server_fd = -1;
+static aios_ipc_server_t g_server;
 static notification_t g_notifications[MAX_NOTIFICATIONS];
 static int g_notification_count = 0;
 static int g_next_id = 1;
 static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
 
-/* ==================== Notification Functions ==================== */
+static int g_free_head = -1;            /* slab freelist */
+static int g_hash[HASH_BUCKETS];        /* id -> slot chains */
+static int g_wheel[WHEEL_BUCKETS];      /* deadline tick -> slot lists */
+static int g_timer_fd = -1;
+static pthread_t g_timer_thread;
 
-static int create_notification(const char *app, const char *summary, 
-                              const char *body, urgency_t urgency, int timeout) {
-    pthread_mutex_lock(&g_lock);
-    
-    int id = g_next_id++;
-    
-    /* Find slot */
-    int slot = -1;
+/* ==================== Slab & Expiry ==================== */
+
+/*
+ * Records live in a fixed slab with a freelist, an id hash for O(1)
+ * close, and a timer wheel of intrusive lists keyed by deadline tick.
+ * One timerfd is armed for the nearest deadline, so the daemon sleeps
+ * until something actually expires. g_lock covers all of it.
+ */
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void slab_init(void) {
     for (int i = 0; i < MAX_NOTIFICATIONS; i++) {
-        if (g_notifications[i].id == 0) {
-            slot = i;
-            break;
+        g_notifications[i].wheel_next = i + 1 < MAX_NOTIFICATIONS ? i + 1 : -1;
+    }
+    g_free_head = 0;
+    for (int i = 0; i < HASH_BUCKETS; i++) g_hash[i] = -1;
+    for (int i = 0; i < WHEEL_BUCKETS; i++) g_wheel[i] = -1;
+}
+
+static void hash_insert(int slot) {
+    int b = g_notifications[slot].id & (HASH_BUCKETS - 1);
+    g_notifications[slot].hash_next = g_hash[b];
+    g_hash[b] = slot;
+}
+
+static void hash_remove(int slot) {
+    int b = g_notifications[slot].id & (HASH_BUCKETS - 1);
+    int *link = &g_hash[b];
+    while (*link >= 0) {
+        if (*link == slot) {
+            *link = g_notifications[slot].hash_next;
+            return;
         }
+        link = &g_notifications[*link].hash_next;
     }
-    
-    if (slot < 0) {
-        /* Remove oldest */
-        memmove(&g_notifications[0], &g_notifications[1], 
-                sizeof(notification_t) * (MAX_NOTIFICATIONS - 1));
-        slot = MAX_NOTIFICATIONS - 1;
+}
+
+static int hash_find(int id) {
+    for (int s = g_hash[id & (HASH_BUCKETS - 1)]; s >= 0;
+         s = g_notifications[s].hash_next) {
+        if (g_notifications[s].id == id) return s;
     }
-    
+    return -1;
+}
+
+static void wheel_insert(int slot) {
+    int b = (int)((g_notifications[slot].deadline / WHEEL_TICK_MS) % WHEEL_BUCKETS);
+    g_notifications[slot].wheel_prev = -1;
+    g_notifications[slot].wheel_next = g_wheel[b];
+    if (g_wheel[b] >= 0) g_notifications[g_wheel[b]].wheel_prev = slot;
+    g_wheel[b] = slot;
+}
+
+static void wheel_remove(int slot) {
+    if (g_notifications[slot].deadline == 0) return;
+    int b = (int)((g_notifications[slot].deadline / WHEEL_TICK_MS) % WHEEL_BUCKETS);
+    int prev = g_notifications[slot].wheel_prev;
+    int next = g_notifications[slot].wheel_next;
+    if (prev >= 0) g_notifications[prev].wheel_next = next;
+    else g_wheel[b] = next;
+    if (next >= 0) g_notifications[next].wheel_prev = prev;
+}
+
+/* Re-arm the timerfd for the nearest deadline (0 entries disarms it) */
+static void timer_rearm(void) {
+    int64_t next = 0;
+    for (int b = 0; b < WHEEL_BUCKETS; b++) {
+        for (int s = g_wheel[b]; s >= 0; s = g_notifications[s].wheel_next) {
+            if (next == 0 || g_notifications[s].deadline < next) {
+                next = g_notifications[s].deadline;
+            }
+        }
+    }
+
+    struct itimerspec its = {0};
+    if (next > 0) {
+        its.it_value.tv_sec = next / 1000;
+        its.it_value.tv_nsec = (next % 1000) * 1000000;
+    }
+    timerfd_settime(g_timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+/* Release a record back to the slab; caller holds g_lock */
+static void slab_release(int slot) {
+    hash_remove(slot);
+    wheel_remove(slot);
+    g_notifications[slot].id = 0;
+    g_notifications[slot].deadline = 0;
+    g_notifications[slot].wheel_next = g_free_head;
+    g_free_head = slot;
+    g_notification_count--;
+}
+
+/* Pop a free slot, evicting the oldest record if the slab is full */
+static int slab_alloc(void) {
+    if (g_free_head < 0) {
+        int oldest = -1;
+        for (int i = 0; i < MAX_NOTIFICATIONS; i++) {
+            if (g_notifications[i].id == 0) continue;
+            if (oldest < 0 ||
+                g_notifications[i].timestamp < g_notifications[oldest].timestamp) {
+                oldest = i;
+            }
+        }
+        slab_release(oldest);
+    }
+    int slot = g_free_head;
+    g_free_head = g_notifications[slot].wheel_next;
+    return slot;
+}
+
+static void expire_due(void) {
+    int64_t now = now_ms();
+    for (int b = 0; b < WHEEL_BUCKETS; b++) {
+        int s = g_wheel[b];
+        while (s >= 0) {
+            int next = g_notifications[s].wheel_next;
+            if (g_notifications[s].deadline <= now) {
+                printf("[NOTIFY] %d expired\n", g_notifications[s].id);
+                slab_release(s);
+            }
+            s = next;
+        }
+    }
+    timer_rearm();
+}
+
+static void *timer_thread(void *arg) {
+    (void)arg;
+
+    while (g_running) {
+        uint64_t ticks;
+        if (read(g_timer_fd, &ticks, sizeof(ticks)) != sizeof(ticks)) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (!g_running) break;
+
+        pthread_mutex_lock(&g_lock);
+        expire_due();
+        pthread_mutex_unlock(&g_lock);
+    }
+    return NULL;
+}
+
+/* ==================== Notification Functions ==================== */
+
+static int create_notification(const char *app, const char *summary,
+                              const char *body, urgency_t urgency, int timeout) {
+    pthread_mutex_lock(&g_lock);
+
+    int id = g_next_id++;
+    int slot = slab_alloc();
+
     notification_t *n = &g_notifications[slot];
     n->id = id;
     strncpy(n->app_name, app ? app : "AI-OS", sizeof(n->app_name) - 1);
@@ -83,11 +238,18 @@ static int create_notification(const char *app, const char *summary,
     n->timeout = timeout;
     n->timestamp = time(NULL);
     n->read = 0;
-    
+
+    hash_insert(slot);
+    n->deadline = timeout > 0 ? now_ms() + timeout : 0;
+    if (n->deadline) {
+        wheel_insert(slot);
+        timer_rearm();
+    }
+
     g_notification_count++;
-    
+
     pthread_mutex_unlock(&g_lock);
-    
+
     /* Display notification */
     const char *urg_str = urgency == URGENCY_CRITICAL ? "critical" :
                           urgency == URGENCY_LOW ? "low" : "normal";
@@ -121,164 +283,116 @@ static int create_notification(const char *app, const char *summary,
 
 static void close_notification(int id) {
     pthread_mutex_lock(&g_lock);
-    
-    for (int i = 0; i < MAX_NOTIFICATIONS; i++) {
-        if (g_notifications[i].id == id) {
-            g_notifications[i].id = 0;
-            g_notification_count--;
-            break;
-        }
+
+    int slot = hash_find(id);
+    if (slot >= 0) {
+        slab_release(slot);
+        timer_rearm();
     }
-    
+
     pthread_mutex_unlock(&g_lock);
 }
 
-/* ==================== IPC Server ==================== */
+/* ==================== Command Handlers ==================== */
 
-static void handle_request(int client_fd, const char *msg, size_t len) {
-    char response[4096] = "{\"status\":\"ok\"}";
-    
-    /* Parse command */
-    if (strstr(msg, "\"cmd\":\"notify\"")) {
-        char summary[256] = "";
-        char body[1024] = "";
-        char app[64] = "AI-OS";
-        urgency_t urgency = URGENCY_NORMAL;
-        int timeout = 5000;
-        
-        /* Extract fields (simple parsing) */
-        char *p;
-        if ((p = strstr(msg, "\"summary\":\""))) {
-            sscanf(p, "\"summary\":\"%255[^\"]\"", summary);
-        }
-        if ((p = strstr(msg, "\"body\":\""))) {
-            sscanf(p, "\"body\":\"%1023[^\"]\"", body);
-        }
-        if ((p = strstr(msg, "\"app_name\":\""))) {
-            sscanf(p, "\"app_name\":\"%63[^\"]\"", app);
-        }
-        if (strstr(msg, "\"urgency\":\"critical\"")) {
-            urgency = URGENCY_CRITICAL;
-        } else if (strstr(msg, "\"urgency\":\"low\"")) {
-            urgency = URGENCY_LOW;
-        }
-        if ((p = strstr(msg, "\"timeout\":"))) {
-            sscanf(p, "\"timeout\":%d", &timeout);
-        }
-        
-        int id = create_notification(app, summary, body, urgency, timeout);
-        snprintf(response, sizeof(response), "{\"status\":\"ok\",\"id\":%d}", id);
+static void cmd_notify(int client_fd, const char *msg,
+                       char *response, size_t response_size) {
+    (void)client_fd;
+
+    char summary[256] = "";
+    char body[1024] = "";
+    char app[64] = "AI-OS";
+    urgency_t urgency = URGENCY_NORMAL;
+    int timeout = 5000;
+
+    /* Extract fields (simple parsing) */
+    const char *p;
+    if ((p = strstr(msg, "\"summary\":\""))) {
+        sscanf(p, "\"summary\":\"%255[^\"]\"", summary);
     }
-    else if (strstr(msg, "\"cmd\":\"close\"")) {
-        int id = 0;
-        char *p = strstr(msg, "\"id\":");
-        if (p) sscanf(p, "\"id\":%d", &id);
-        close_notification(id);
+    if ((p = strstr(msg, "\"body\":\""))) {
+        sscanf(p, "\"body\":\"%1023[^\"]\"", body);
     }
-    else if (strstr(msg, "\"cmd\":\"list\"")) {
-        pthread_mutex_lock(&g_lock);
-        
-        char *ptr = response;
-        ptr += sprintf(ptr, "{\"status\":\"ok\",\"notifications\":[");
-        
-        int first = 1;
-        for (int i = 0; i < MAX_NOTIFICATIONS; i++) {
-            if (g_notifications[i].id == 0) continue;
-            
-            notification_t *n = &g_notifications[i];
-            if (!first) ptr += sprintf(ptr, ",");
-            first = 0;
-            
-            ptr += sprintf(ptr, 
-                "{\"id\":%d,\"app\":\"%s\",\"summary\":\"%s\",\"read\":%s}",
-                n->id, n->app_name, n->summary, n->read ? "true" : "false");
-        }
-        
-        ptr += sprintf(ptr, "]}");
-        
-        pthread_mutex_unlock(&g_lock);
+    if ((p = strstr(msg, "\"app_name\":\""))) {
+        sscanf(p, "\"app_name\":\"%63[^\"]\"", app);
     }
-    else if (strstr(msg, "\"cmd\":\"clear\"")) {
-        pthread_mutex_lock(&g_lock);
-        memset(g_notifications, 0, sizeof(g_notifications));
-        g_notification_count = 0;
-        pthread_mutex_unlock(&g_lock);
+    if (strstr(msg, "\"urgency\":\"critical\"")) {
+        urgency = URGENCY_CRITICAL;
+    } else if (strstr(msg, "\"urgency\":\"low\"")) {
+        urgency = URGENCY_LOW;
     }
-    
-    /* Send response */
-    uint32_t resp_len = htonl(strlen(response));
-    send(client_fd, &resp_len, 4, 0);
-    send(client_fd, response, strlen(response), 0);
+    if ((p = strstr(msg, "\"timeout\":"))) {
+        sscanf(p, "\"timeout\":%d", &timeout);
+    }
+
+    int id = create_notification(app, summary, body, urgency, timeout);
+    snprintf(response, response_size, "{\"status\":\"ok\",\"id\":%d}", id);
 }
 
-static void *client_handler(void *arg) {
-    int client_fd = *(int *)arg;
-    free(arg);
-    
-    while (1) {
-        uint32_t length;
-        if (recv(client_fd, &length, 4, 0) != 4) break;
-        length = ntohl(length);
-        
-        if (length > 8192) break;
-        
-        char *msg = malloc(length + 1);
-        if (!msg) break;
-        
-        if (recv(client_fd, msg, length, 0) != length) {
-            free(msg);
-            break;
-        }
-        msg[length] = '\0';
-        
-        handle_request(client_fd, msg, length);
-        free(msg);
-    }
-    
-    close(client_fd);
-    return NULL;
+static void cmd_close(int client_fd, const char *msg,
+                      char *response, size_t response_size) {
+    (void)client_fd;
+    (void)response;
+    (void)response_size;
+
+    int id = 0;
+    const char *p = strstr(msg, "\"id\":");
+    if (p) sscanf(p, "\"id\":%d", &id);
+    close_notification(id);
 }
 
-static int run_server(void) {
-    g_server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (g_server_fd < 0) {
-        perror("socket");
-        return -1;
-    }
-    
-    struct sockaddr_un addr = {0};
-    addr.sun_family = AF_UNIX;
-    strncpy(addr.sun_path, SOCKET_PATH, sizeof(addr.sun_path) - 1);
-    
-    unlink(SOCKET_PATH);
-    
-    if (bind(g_server_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-        perror("bind");
-        return -1;
+static void cmd_list(int client_fd, const char *msg,
+                     char *response, size_t response_size) {
+    (void)client_fd;
+    (void)msg;
+    (void)response_size;
+
+    pthread_mutex_lock(&g_lock);
+
+    char *ptr = response;
+    ptr += sprintf(ptr, "{\"status\":\"ok\",\"notifications\":[");
+
+    int first = 1;
+    for (int i = 0; i < MAX_NOTIFICATIONS; i++) {
+        if (g_notifications[i].id == 0) continue;
+
+        notification_t *n = &g_notifications[i];
+        if (!first) ptr += sprintf(ptr, ",");
+        first = 0;
+
+        ptr += sprintf(ptr,
+            "{\"id\":%d,\"app\":\"%s\",\"summary\":\"%s\",\"read\":%s}",
+            n->id, n->app_name, n->summary, n->read ? "true" : "false");
     }
-    
-    chmod(SOCKET_PATH, 0666);
-    listen(g_server_fd, 5);
-    
-    printf("[NOTIFY] Listening on %s\n", SOCKET_PATH);
-    
-    while (g_running) {
-        int *client_fd = malloc(sizeof(int));
-        *client_fd = accept(g_server_fd, NULL, NULL);
-        
-        if (*client_fd < 0) {
-            free(client_fd);
-            continue;
-        }
-        
-        pthread_t thread;
-        pthread_create(&thread, NULL, client_handler, client_fd);
-        pthread_detach(thread);
+
+    ptr += sprintf(ptr, "]}");
+
+    pthread_mutex_unlock(&g_lock);
+}
+
+static void cmd_clear(int client_fd, const char *msg,
+                      char *response, size_t response_size) {
+    (void)client_fd;
+    (void)msg;
+    (void)response;
+    (void)response_size;
+
+    pthread_mutex_lock(&g_lock);
+    for (int i = 0; i < MAX_NOTIFICATIONS; i++) {
+        if (g_notifications[i].id != 0) slab_release(i);
     }
-    
-    return 0;
+    timer_rearm();
+    pthread_mutex_unlock(&g_lock);
 }
 
+static const aios_ipc_cmd_t g_commands[] = {
+    { "notify", cmd_notify },
+    { "close",  cmd_close },
+    { "list",   cmd_list },
+    { "clear",  cmd_clear },
+    { NULL, NULL }
+};
+
 /* ==================== Main ==================== */
 
 static void signal_handler(int sig) {
@@ -292,14 +406,32 @@ int main(int argc, char *argv[]) {
     signal(SIGTERM, signal_handler);
     
     mkdir("/run/aios", 0755);
-    
-    run_server();
-    
-    if (g_server_fd >= 0) {
-        close(g_server_fd);
-        unlink(SOCKET_PATH);
+
+    slab_init();
+    g_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (g_timer_fd < 0) {
+        perror("timerfd_create");
+        return 1;
     }
-    
+    pthread_create(&g_timer_thread, NULL, timer_thread, NULL);
+
+    if (aios_ipc_server_init(&g_server, SOCKET_PATH, g_commands) < 0) {
+        perror("aios_ipc_server_init");
+        return 1;
+    }
+
+    printf("[NOTIFY] Listening on %s\n", SOCKET_PATH);
+
+    aios_ipc_server_run(&g_server, &g_running);
+
+    /* Fire the timer once so the expiry thread notices shutdown */
+    struct itimerspec wake = { .it_value.tv_nsec = 1 };
+    timerfd_settime(g_timer_fd, 0, &wake, NULL);
+    pthread_join(g_timer_thread, NULL);
+    close(g_timer_fd);
+
+    aios_ipc_server_close(&g_server);
+
     printf("[NOTIFY] Notification daemon stopped\n");
     return 0;
 }
@@ -2,7 +2,7 @@
  * AI-OS Power Manager
  * Battery monitoring and power management in C.
  * 
- * Compile: gcc -o aios-power power.c hal.c -lpthread
+ * Compile: gcc -o aios-power power.c hal.c -I../../ipc -laios-ipc -lpthread
  */
 
 #define _GNU_SOURCE
@@ -13,10 +13,13 @@
 #include <signal.h>
 #include <pthread.h>
 #include <errno.h>
+#include <poll.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <linux/netlink.h>
 
 #include "hal.h"
+#include "ipc.h"
 
 /* ==================== Configuration ==================== */
 
@@ -33,7 +36,7 @@ typedef struct {
 /* ==================== Globals ==================== */
 
 static volatile int g_running = 1;
-static int g_server_fd = -1;
+static aios_ipc_server_t g_server;
 static power_config_t g_config = {15, 5, 0, 1};
 static int g_last_battery_level = -1;
 
@@ -132,130 +135,175 @@ static void check_battery(void) {
     }
 }
 
-static void *battery_monitor_thread(void *arg) {
-    while (g_running) {
-        check_battery();
-        sleep(60);  /* Check every minute */
+/* Subscribe to kernel uevent broadcasts (what udev listens to) */
+static int uevent_open(void) {
+    int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+    if (fd < 0) return -1;
+
+    struct sockaddr_nl addr = {0};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_pid = getpid();
+    addr.nl_groups = 1;  /* kernel multicast group */
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
     }
-    return NULL;
+    return fd;
 }
 
-/* ==================== IPC Server ==================== */
-
-static void handle_client(int client_fd) {
-    uint32_t length;
-    if (recv(client_fd, &length, 4, 0) != 4) return;
-    length = ntohl(length);
-    
-    if (length > 4096) return;
-    
-    char *msg = malloc(length + 1);
-    if (!msg) return;
-    
-    if (recv(client_fd, msg, length, 0) != length) {
-        free(msg);
-        return;
+/* True if the uevent buffer carries a power_supply event */
+static int uevent_is_power_supply(const char *buf, ssize_t len) {
+    /* "action@devpath\0KEY=VALUE\0..." */
+    for (ssize_t off = 0; off < len; off += strlen(buf + off) + 1) {
+        if (strcmp(buf + off, "SUBSYSTEM=power_supply") == 0) return 1;
     }
-    msg[length] = '\0';
-    
-    char response[1024] = "{\"status\":\"ok\"}";
-    
-    /* Parse command */
-    if (strstr(msg, "\"cmd\":\"battery\"")) {
-        battery_info_t bat;
-        hal_battery_get(&bat);
-        
-        snprintf(response, sizeof(response),
-            "{\"status\":\"ok\",\"battery\":{"
-            "\"present\":%s,\"level\":%d,\"status\":\"%s\","
-            "\"time_to_empty\":%d,\"time_to_full\":%d}}",
-            bat.present ? "true" : "false",
-            bat.level, bat.status,
-            bat.time_to_empty, bat.time_to_full);
+    return 0;
+}
+
+/*
+ * Event-driven: block on the uevent socket and re-check the battery
+ * the moment the kernel reports a power_supply change (plug/unplug,
+ * charge thresholds). A long safety-net timeout catches missed events;
+ * plain 60s polling remains as the fallback when netlink is unavailable.
+ */
+static void *battery_monitor_thread(void *arg) {
+    (void)arg;
+
+    int nl_fd = uevent_open();
+    if (nl_fd < 0) {
+        printf("[POWER] uevent socket unavailable, polling every 60s\n");
     }
-    else if (strstr(msg, "\"cmd\":\"profile\"")) {
-        if (strstr(msg, "\"set\":\"performance\"")) {
-            set_power_profile(PROFILE_PERFORMANCE);
-        } else if (strstr(msg, "\"set\":\"powersave\"")) {
-            set_power_profile(PROFILE_POWERSAVE);
-        } else if (strstr(msg, "\"set\":\"balanced\"")) {
-            set_power_profile(PROFILE_BALANCED);
+
+    check_battery();
+
+    while (g_running) {
+        if (nl_fd < 0) {
+            sleep(60);
+            if (g_running) check_battery();
+            continue;
         }
-        
-        const char *profile_name = "balanced";
-        if (g_current_profile == PROFILE_PERFORMANCE) profile_name = "performance";
-        else if (g_current_profile == PROFILE_POWERSAVE) profile_name = "powersave";
-        
-        snprintf(response, sizeof(response),
-            "{\"status\":\"ok\",\"profile\":\"%s\"}", profile_name);
-    }
-    else if (strstr(msg, "\"cmd\":\"suspend\"")) {
-        hal_suspend();
-    }
-    else if (strstr(msg, "\"cmd\":\"hibernate\"")) {
-        hal_hibernate();
-    }
-    else if (strstr(msg, "\"cmd\":\"poweroff\"")) {
-        hal_poweroff();
-    }
-    else if (strstr(msg, "\"cmd\":\"reboot\"")) {
-        hal_reboot();
-    }
-    else if (strstr(msg, "\"cmd\":\"brightness\"")) {
-        char *set_ptr = strstr(msg, "\"set\":");
-        if (set_ptr) {
-            int level;
-            if (sscanf(set_ptr, "\"set\":%d", &level) == 1) {
-                hal_brightness_set(level);
-            }
+
+        struct pollfd pfd = { .fd = nl_fd, .events = POLLIN, .revents = 0 };
+        int ret = poll(&pfd, 1, 5 * 60 * 1000);
+        if (!g_running) break;
+
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            close(nl_fd);
+            nl_fd = -1;  /* netlink broke; drop to polling */
+            continue;
+        }
+
+        if (ret == 0) {
+            check_battery();  /* safety net */
+            continue;
+        }
+
+        char buf[4096];
+        ssize_t len = recv(nl_fd, buf, sizeof(buf) - 1, 0);
+        if (len <= 0) continue;
+        buf[len] = '\0';
+
+        if (uevent_is_power_supply(buf, len)) {
+            check_battery();
         }
-        int brightness = hal_brightness_get();
-        snprintf(response, sizeof(response),
-            "{\"status\":\"ok\",\"brightness\":%d}", brightness);
     }
-    
-    free(msg);
-    
-    /* Send response */
-    uint32_t resp_len = htonl(strlen(response));
-    send(client_fd, &resp_len, 4, 0);
-    send(client_fd, response, strlen(response), 0);
+
+    if (nl_fd >= 0) close(nl_fd);
+    return NULL;
 }
 
-static int run_server(void) {
-    g_server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (g_server_fd < 0) {
-        perror("socket");
-        return -1;
-    }
-    
-    struct sockaddr_un addr = {0};
-    addr.sun_family = AF_UNIX;
-    strncpy(addr.sun_path, SOCKET_PATH, sizeof(addr.sun_path) - 1);
-    
-    unlink(SOCKET_PATH);
-    
-    if (bind(g_server_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-        perror("bind");
-        return -1;
+/* ==================== Command Handlers ==================== */
+
+static void cmd_battery(int client_fd, const char *msg,
+                        char *response, size_t response_size) {
+    (void)client_fd;
+    (void)msg;
+
+    battery_info_t bat;
+    hal_battery_get(&bat);
+
+    snprintf(response, response_size,
+        "{\"status\":\"ok\",\"battery\":{"
+        "\"present\":%s,\"level\":%d,\"status\":\"%s\","
+        "\"time_to_empty\":%d,\"time_to_full\":%d}}",
+        bat.present ? "true" : "false",
+        bat.level, bat.status,
+        bat.time_to_empty, bat.time_to_full);
+}
+
+static void cmd_profile(int client_fd, const char *msg,
+                        char *response, size_t response_size) {
+    (void)client_fd;
+
+    if (strstr(msg, "\"set\":\"performance\"")) {
+        set_power_profile(PROFILE_PERFORMANCE);
+    } else if (strstr(msg, "\"set\":\"powersave\"")) {
+        set_power_profile(PROFILE_POWERSAVE);
+    } else if (strstr(msg, "\"set\":\"balanced\"")) {
+        set_power_profile(PROFILE_BALANCED);
     }
-    
-    chmod(SOCKET_PATH, 0666);
-    listen(g_server_fd, 5);
-    
-    printf("[POWER] Listening on %s\n", SOCKET_PATH);
-    
-    while (g_running) {
-        int client = accept(g_server_fd, NULL, NULL);
-        if (client < 0) continue;
-        
-        handle_client(client);
-        close(client);
+
+    const char *profile_name = "balanced";
+    if (g_current_profile == PROFILE_PERFORMANCE) profile_name = "performance";
+    else if (g_current_profile == PROFILE_POWERSAVE) profile_name = "powersave";
+
+    snprintf(response, response_size,
+        "{\"status\":\"ok\",\"profile\":\"%s\"}", profile_name);
+}
+
+static void cmd_suspend(int client_fd, const char *msg,
+                        char *response, size_t response_size) {
+    (void)client_fd; (void)msg; (void)response; (void)response_size;
+    hal_suspend();
+}
+
+static void cmd_hibernate(int client_fd, const char *msg,
+                          char *response, size_t response_size) {
+    (void)client_fd; (void)msg; (void)response; (void)response_size;
+    hal_hibernate();
+}
+
+static void cmd_poweroff(int client_fd, const char *msg,
+                         char *response, size_t response_size) {
+    (void)client_fd; (void)msg; (void)response; (void)response_size;
+    hal_poweroff();
+}
+
+static void cmd_reboot(int client_fd, const char *msg,
+                       char *response, size_t response_size) {
+    (void)client_fd; (void)msg; (void)response; (void)response_size;
+    hal_reboot();
+}
+
+static void cmd_brightness(int client_fd, const char *msg,
+                           char *response, size_t response_size) {
+    (void)client_fd;
+
+    const char *set_ptr = strstr(msg, "\"set\":");
+    if (set_ptr) {
+        int level;
+        if (sscanf(set_ptr, "\"set\":%d", &level) == 1) {
+            hal_brightness_set(level);
+        }
     }
-    
-    return 0;
+    int brightness = hal_brightness_get();
+    snprintf(response, response_size,
+        "{\"status\":\"ok\",\"brightness\":%d}", brightness);
 }
 
+static const aios_ipc_cmd_t g_commands[] = {
+    { "battery",    cmd_battery },
+    { "profile",    cmd_profile },
+    { "suspend",    cmd_suspend },
+    { "hibernate",  cmd_hibernate },
+    { "poweroff",   cmd_poweroff },
+    { "reboot",     cmd_reboot },
+    { "brightness", cmd_brightness },
+    { NULL, NULL }
+};
+
 /* ==================== Main ==================== */
 
 static void signal_handler(int sig) {
@@ -278,16 +326,21 @@ int main(int argc, char *argv[]) {
     pthread_create(&battery_thread, NULL, battery_monitor_thread, NULL);
     
     /* Run IPC server */
-    run_server();
-    
-    /* Cleanup */
-    pthread_join(battery_thread, NULL);
-    
-    if (g_server_fd >= 0) {
-        close(g_server_fd);
-        unlink(SOCKET_PATH);
+    if (aios_ipc_server_init(&g_server, SOCKET_PATH, g_commands) < 0) {
+        perror("aios_ipc_server_init");
+        return 1;
     }
-    
+
+    printf("[POWER] Listening on %s\n", SOCKET_PATH);
+
+    aios_ipc_server_run(&g_server, &g_running);
+
+    /* Cleanup; interrupt the monitor's poll so it sees g_running */
+    pthread_kill(battery_thread, SIGTERM);
+    pthread_join(battery_thread, NULL);
+
+    aios_ipc_server_close(&g_server);
+
     printf("[POWER] Power manager stopped\n");
     return 0;
 }
@@ -0,0 +1,205 @@
+/**
+ * AI-OS Voice Activity Detection Implementation
+ * SIMD-vectorized energy + zero-crossing features, scalar decision logic.
+ *
+ * The feature kernel is picked once at runtime: AVX2 or SSE2 on x86 (via
+ * __builtin_cpu_supports), NEON on ARM builds that define __ARM_NEON,
+ * scalar otherwise. The decision combines block energy against an
+ * adaptive noise floor with a zero-crossing-rate band, so steady fan
+ * noise (low ZCR) and broadband hiss (high ZCR) no longer trigger a
+ * recognition pass.
+ *
+ * Compile: built into aios-voice (see core/Makefile)
+ */
+
+#include <stdlib.h>
+
+#include "vad.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VAD_X86 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/* ==================== Feature Kernels ==================== */
+
+static void features_scalar(const int16_t *x, int n,
+                            int32_t *energy, int32_t *crossings) {
+    int64_t sum = 0;
+    int32_t zc = 0;
+
+    for (int i = 0; i < n; i++) {
+        sum += abs(x[i]);
+        if (i + 1 < n && ((x[i] ^ x[i + 1]) < 0)) zc++;
+    }
+
+    *energy = (n > 0) ? (int32_t)(sum / n) : 0;
+    *crossings = zc;
+}
+
+#ifdef VAD_X86
+
+__attribute__((target("sse2")))
+static void features_sse2(const int16_t *x, int n,
+                          int32_t *energy, int32_t *crossings) {
+    __m128i acc = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+    int i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(x + i));
+        /* abs via max(v, -v); SSE2 has no _mm_abs_epi16 */
+        __m128i av = _mm_max_epi16(v, _mm_sub_epi16(_mm_setzero_si128(), v));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(av, ones));
+    }
+
+    int32_t lanes[4];
+    _mm_storeu_si128((__m128i *)lanes, acc);
+    int64_t sum = (int64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < n; i++) sum += abs(x[i]);
+
+    /* Sign changes between neighbours: xor sign bit, one bit per lane */
+    int32_t zc = 0;
+    for (i = 0; i + 9 <= n; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(x + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(x + i + 1));
+        int mask = _mm_movemask_epi8(_mm_xor_si128(a, b));
+        zc += __builtin_popcount(mask & 0xAAAA);
+    }
+    for (; i + 1 < n; i++)
+        if ((x[i] ^ x[i + 1]) < 0) zc++;
+
+    *energy = (n > 0) ? (int32_t)(sum / n) : 0;
+    *crossings = zc;
+}
+
+__attribute__((target("avx2")))
+static void features_avx2(const int16_t *x, int n,
+                          int32_t *energy, int32_t *crossings) {
+    __m256i acc = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi16(1);
+    int i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(x + i));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_abs_epi16(v), ones));
+    }
+
+    int32_t lanes[8];
+    _mm256_storeu_si256((__m256i *)lanes, acc);
+    int64_t sum = 0;
+    for (int l = 0; l < 8; l++) sum += lanes[l];
+    for (; i < n; i++) sum += abs(x[i]);
+
+    int32_t zc = 0;
+    for (i = 0; i + 17 <= n; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(x + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(x + i + 1));
+        int mask = _mm256_movemask_epi8(_mm256_xor_si256(a, b));
+        zc += __builtin_popcount(mask & 0xAAAAAAAA);
+    }
+    for (; i + 1 < n; i++)
+        if ((x[i] ^ x[i + 1]) < 0) zc++;
+
+    *energy = (n > 0) ? (int32_t)(sum / n) : 0;
+    *crossings = zc;
+}
+
+#elif defined(__ARM_NEON)
+
+static void features_neon(const int16_t *x, int n,
+                          int32_t *energy, int32_t *crossings) {
+    int32x4_t acc = vdupq_n_s32(0);
+    int i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t v = vld1q_s16(x + i);
+        acc = vpadalq_s16(acc, vabsq_s16(v));
+    }
+
+    int64_t sum = (int64_t)vgetq_lane_s32(acc, 0) + vgetq_lane_s32(acc, 1) +
+                  vgetq_lane_s32(acc, 2) + vgetq_lane_s32(acc, 3);
+    for (; i < n; i++) sum += abs(x[i]);
+
+    uint32x4_t zacc = vdupq_n_u32(0);
+    for (i = 0; i + 9 <= n; i += 8) {
+        int16x8_t a = vld1q_s16(x + i);
+        int16x8_t b = vld1q_s16(x + i + 1);
+        uint16x8_t sign = vshrq_n_u16(vreinterpretq_u16_s16(veorq_s16(a, b)), 15);
+        zacc = vpadalq_u16(zacc, sign);
+    }
+    int32_t zc = (int32_t)(vgetq_lane_u32(zacc, 0) + vgetq_lane_u32(zacc, 1) +
+                           vgetq_lane_u32(zacc, 2) + vgetq_lane_u32(zacc, 3));
+    for (; i + 1 < n; i++)
+        if ((x[i] ^ x[i + 1]) < 0) zc++;
+
+    *energy = (n > 0) ? (int32_t)(sum / n) : 0;
+    *crossings = zc;
+}
+
+#endif
+
+/* ==================== Runtime Dispatch ==================== */
+
+typedef void (*vad_features_fn)(const int16_t *, int, int32_t *, int32_t *);
+
+static vad_features_fn select_features(void) {
+#if defined(VAD_X86)
+    if (__builtin_cpu_supports("avx2")) return features_avx2;
+    if (__builtin_cpu_supports("sse2")) return features_sse2;
+#elif defined(__ARM_NEON)
+    return features_neon;
+#endif
+    return features_scalar;
+}
+
+void vad_features(const int16_t *samples, int frames,
+                  int32_t *energy, int32_t *crossings) {
+    static vad_features_fn fn = NULL;
+    if (!fn) fn = select_features();
+    fn(samples, frames, energy, crossings);
+}
+
+/* ==================== Decision Logic ==================== */
+
+#define VAD_FLOOR_INIT   200.0f
+#define VAD_FLOOR_MIN    50.0f
+#define VAD_WARMUP       10      /* blocks used to seed the floor */
+#define VAD_ATTACK       0.02f   /* floor adaptation while quiet */
+#define VAD_RELEASE      0.001f  /* floor adaptation during speech */
+#define VAD_ENERGY_RATIO 2.5f    /* speech must exceed floor by this */
+#define VAD_ZCR_MIN      0.02f   /* below: steady hum / fan rumble */
+#define VAD_ZCR_MAX      0.35f   /* above: broadband hiss */
+
+void vad_init(vad_state_t *vad) {
+    vad->noise_floor = VAD_FLOOR_INIT;
+    vad->warmup = VAD_WARMUP;
+}
+
+int vad_process(vad_state_t *vad, const int16_t *samples, int frames) {
+    if (!samples || frames <= 0) return 0;
+
+    int32_t energy, crossings;
+    vad_features(samples, frames, &energy, &crossings);
+    float zcr = (float)crossings / (float)frames;
+
+    /* Seed the noise floor from the first blocks after startup */
+    if (vad->warmup > 0) {
+        vad->warmup--;
+        vad->noise_floor += ((float)energy - vad->noise_floor) * 0.3f;
+        if (vad->noise_floor < VAD_FLOOR_MIN) vad->noise_floor = VAD_FLOOR_MIN;
+        return 0;
+    }
+
+    int speech = ((float)energy > vad->noise_floor * VAD_ENERGY_RATIO) &&
+                 zcr >= VAD_ZCR_MIN && zcr <= VAD_ZCR_MAX;
+
+    /* Track the floor quickly while quiet, barely during speech */
+    float alpha = speech ? VAD_RELEASE : VAD_ATTACK;
+    vad->noise_floor += ((float)energy - vad->noise_floor) * alpha;
+    if (vad->noise_floor < VAD_FLOOR_MIN) vad->noise_floor = VAD_FLOOR_MIN;
+
+    return speech;
+}
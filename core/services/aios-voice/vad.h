@@ -0,0 +1,34 @@
+/**
+ * AI-OS Voice Activity Detection
+ * Energy + zero-crossing VAD with an adaptive noise floor.
+ *
+ * Compile: built into aios-voice (see core/Makefile)
+ */
+
+#ifndef AIOS_VAD_H
+#define AIOS_VAD_H
+
+#include <stdint.h>
+
+typedef struct {
+    float noise_floor;      /* adaptive mean-|x| noise estimate */
+    int warmup;             /* blocks left while seeding the floor */
+} vad_state_t;
+
+/* Reset state and start re-learning the noise floor */
+void vad_init(vad_state_t *vad);
+
+/**
+ * Classify one block of mono S16 samples
+ * Returns 1 if the block contains speech, 0 otherwise
+ */
+int vad_process(vad_state_t *vad, const int16_t *samples, int frames);
+
+/**
+ * Raw feature kernel (runtime-dispatched SIMD):
+ * mean |x| over the block and the zero-crossing count
+ */
+void vad_features(const int16_t *samples, int frames,
+                  int32_t *energy, int32_t *crossings);
+
+#endif /* AIOS_VAD_H */
@@ -2,21 +2,24 @@
  * AI-OS Voice Service
  * Speech recognition and TTS in C using PocketSphinx and eSpeak.
  * 
- * Compile: gcc -o aios-voice voice.c -lpocketsphinx -lsphinxbase -lasound -lpthread
+ * Compile: gcc -o aios-voice voice.c vad.c -I../../ipc -L../../ipc -laios-ipc -lpocketsphinx -lsphinxbase -lasound -lpthread
  */
 
 #define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
 #include <unistd.h>
 #include <signal.h>
 #include <pthread.h>
 #include <errno.h>
-#include <sys/socket.h>
-#include <sys/un.h>
 #include <alsa/asoundlib.h>
 
+#include "ipc.h"
+#include "vad.h"
+
 /* PocketSphinx for speech recognition */
 #ifdef USE_POCKETSPHINX
 #include <pocketsphinx.h>
@@ -32,6 +35,8 @@
 static volatile int g_running = 1;
 static int g_voice_enabled = 1;
 static char g_wake_word[64] = WAKE_WORD;
+static vad_state_t g_vad;
+static aios_ipc_t g_agent;
 
 /* ==================== Text-to-Speech ==================== */
 
@@ -49,40 +54,10 @@ static void tts_speak(const char *text) {
 /* ==================== Agent Communication ==================== */
 
 static int send_to_agent(const char *text, char *response, size_t response_size) {
-    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (sock < 0) return -1;
-    
-    struct sockaddr_un addr = {0};
-    addr.sun_family = AF_UNIX;
-    strcpy(addr.sun_path, AGENT_SOCKET);
-    
-    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-        close(sock);
-        return -1;
-    }
-    
-    /* Build message */
     char msg[2048];
     snprintf(msg, sizeof(msg), "{\"cmd\":\"chat\",\"text\":\"%s\"}", text);
-    
-    uint32_t len = htonl(strlen(msg));
-    send(sock, &len, 4, 0);
-    send(sock, msg, strlen(msg), 0);
-    
-    /* Receive response */
-    if (recv(sock, &len, 4, 0) != 4) {
-        close(sock);
-        return -1;
-    }
-    len = ntohl(len);
-    
-    if (len < response_size) {
-        recv(sock, response, len, 0);
-        response[len] = '\0';
-    }
-    
-    close(sock);
-    return 0;
+
+    return aios_ipc_request(&g_agent, msg, response, response_size);
 }
 
 static void process_command(const char *command) {
@@ -152,15 +127,75 @@ static snd_pcm_t *open_audio_capture(void) {
     return handle;
 }
 
-/* ==================== Simple Voice Activity Detection ==================== */
+/* ==================== Capture Pipeline ==================== */
+
+/*
+ * Capture and processing are split across two threads joined by a
+ * lock-free SPSC ring of audio blocks. The capture thread only reads
+ * from ALSA and copies into the ring, so a slow recognition pass or a
+ * multi-second agent round-trip no longer overruns the PCM and eats the
+ * first words of the next command. When the ring fills the oldest
+ * unconsumed audio is dropped (counted), never the capture.
+ */
+
+#define AUDIO_BLOCK_FRAMES 1024
+#define AUDIO_RING_BLOCKS  64   /* ~4 seconds of backlog at 16 kHz */
 
-static int detect_voice_activity(int16_t *buffer, int frames) {
-    int32_t sum = 0;
-    for (int i = 0; i < frames; i++) {
-        sum += abs(buffer[i]);
+typedef struct {
+    int16_t samples[AUDIO_BLOCK_FRAMES];
+    int frames;
+} audio_block_t;
+
+static audio_block_t g_audio_ring[AUDIO_RING_BLOCKS];
+static _Atomic unsigned g_ring_head = 0;     /* written by capture only */
+static _Atomic unsigned g_ring_tail = 0;     /* written by processing only */
+static _Atomic unsigned g_ring_dropped = 0;
+
+/* Producer side: copy one captured block in; drops instead of blocking */
+static int ring_push(const int16_t *samples, int frames) {
+    unsigned head = atomic_load_explicit(&g_ring_head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&g_ring_tail, memory_order_acquire);
+
+    if (head - tail >= AUDIO_RING_BLOCKS) {
+        atomic_fetch_add_explicit(&g_ring_dropped, 1, memory_order_relaxed);
+        return -1;
+    }
+
+    audio_block_t *blk = &g_audio_ring[head % AUDIO_RING_BLOCKS];
+    memcpy(blk->samples, samples, (size_t)frames * sizeof(int16_t));
+    blk->frames = frames;
+
+    atomic_store_explicit(&g_ring_head, head + 1, memory_order_release);
+    return 0;
+}
+
+/* Consumer side: peek the next block, or NULL if the ring is empty */
+static audio_block_t *ring_pop(void) {
+    unsigned tail = atomic_load_explicit(&g_ring_tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&g_ring_head, memory_order_acquire);
+
+    if (tail == head) return NULL;
+    return &g_audio_ring[tail % AUDIO_RING_BLOCKS];
+}
+
+/* Consumer side: hand the peeked block back to the producer */
+static void ring_release(void) {
+    atomic_fetch_add_explicit(&g_ring_tail, 1, memory_order_release);
+}
+
+static void *capture_thread(void *arg) {
+    snd_pcm_t *audio = arg;
+    int16_t buffer[AUDIO_BLOCK_FRAMES];
+
+    while (g_running) {
+        int frames = snd_pcm_readi(audio, buffer, AUDIO_BLOCK_FRAMES);
+        if (frames < 0) {
+            snd_pcm_recover(audio, frames, 0);
+            continue;
+        }
+        if (frames > 0) ring_push(buffer, frames);
     }
-    int avg = sum / frames;
-    return avg > 500;  /* Threshold */
+    return NULL;
 }
 
 /* ==================== Speech Recognition Loop ==================== */
@@ -188,21 +223,25 @@ static void recognition_loop(void) {
     }
     
     ps_start_utt(decoder);
-    
-    int16_t buffer[1024];
+
+    pthread_t capture;
+    pthread_create(&capture, NULL, capture_thread, audio);
+
     int listening_for_command = 0;
     int silence_frames = 0;
     char command[256] = {0};
-    
+
     printf("[VOICE] Listening for wake word: '%s'\n", g_wake_word);
-    
+
     while (g_running) {
-        int frames = snd_pcm_readi(audio, buffer, 1024);
-        if (frames < 0) {
-            snd_pcm_recover(audio, frames, 0);
+        audio_block_t *blk = ring_pop();
+        if (!blk) {
+            usleep(2000);
             continue;
         }
-        
+        int16_t *buffer = blk->samples;
+        int frames = blk->frames;
+
         ps_process_raw(decoder, buffer, frames, FALSE, FALSE);
         
         const char *hyp = ps_get_hyp(decoder, NULL);
@@ -226,7 +265,7 @@ static void recognition_loop(void) {
                 strncpy(command, hyp, sizeof(command) - 1);
                 
                 /* Check for silence */
-                if (!detect_voice_activity(buffer, frames)) {
+                if (!vad_process(&g_vad, buffer, frames)) {
                     silence_frames++;
                     if (silence_frames > 20) {  /* ~1 second of silence */
                         if (command[0]) {
@@ -242,8 +281,12 @@ static void recognition_loop(void) {
                 }
             }
         }
+
+        ring_release();
     }
-    
+
+    pthread_join(capture, NULL);
+
     ps_end_utt(decoder);
     ps_free(decoder);
     ps_config_free(config);
@@ -275,19 +318,22 @@ static void recognition_loop(void) {
         return;
     }
     
-    int16_t buffer[1024];
+    pthread_t capture;
+    pthread_create(&capture, NULL, capture_thread, audio);
+
     int was_speaking = 0;
     int silence_count = 0;
-    
+
     while (g_running) {
-        int frames = snd_pcm_readi(audio, buffer, 1024);
-        if (frames < 0) {
-            snd_pcm_recover(audio, frames, 0);
+        audio_block_t *blk = ring_pop();
+        if (!blk) {
+            usleep(2000);
             continue;
         }
-        
-        int is_speaking = detect_voice_activity(buffer, frames);
-        
+
+        int is_speaking = vad_process(&g_vad, blk->samples, blk->frames);
+        ring_release();
+
         if (is_speaking && !was_speaking) {
             printf("[VOICE] Voice activity detected\n");
         } else if (!is_speaking && was_speaking) {
@@ -298,11 +344,11 @@ static void recognition_loop(void) {
                 silence_count = 0;
             }
         }
-        
+
         was_speaking = is_speaking;
-        usleep(10000);
     }
-    
+
+    pthread_join(capture, NULL);
     snd_pcm_close(audio);
 }
 
@@ -319,7 +365,10 @@ int main(int argc, char *argv[]) {
     
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
-    
+
+    vad_init(&g_vad);
+    aios_ipc_init(&g_agent, AGENT_SOCKET);
+
     /* Load config */
     FILE *f = fopen("/etc/aios/voice.json", "r");
     if (f) {
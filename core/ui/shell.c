@@ -2,18 +2,18 @@
  * AI-OS Shell UI
  * GTK4-based desktop shell in C.
  * 
- * Compile: gcc -o aios-shell shell.c `pkg-config --cflags --libs gtk4` -lpthread
+ * Compile: gcc -o aios-shell shell.c -I../ipc -L../ipc -laios-ipc `pkg-config --cflags --libs gtk4` -lpthread
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
-#include <sys/socket.h>
-#include <sys/un.h>
 #include <pthread.h>
 #include <gtk/gtk.h>
 
+#include "ipc.h"
+
 #define AGENT_SOCKET "/run/aios/agent.sock"
 
 /* ==================== Globals ==================== */
@@ -27,40 +27,89 @@ static GtkWidget *g_status_bar;
 
 /* ==================== Agent Communication ==================== */
 
-static int send_to_agent(const char *text, char *response, size_t response_size) {
-    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (sock < 0) return -1;
-    
-    struct sockaddr_un addr = {0};
-    addr.sun_family = AF_UNIX;
-    strcpy(addr.sun_path, AGENT_SOCKET);
-    
-    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-        close(sock);
-        strcpy(response, "Agent not running");
-        return -1;
-    }
-    
-    char msg[2048];
-    snprintf(msg, sizeof(msg), "{\"cmd\":\"chat\",\"text\":\"%s\"}", text);
-    
-    uint32_t len = htonl(strlen(msg));
-    send(sock, &len, 4, 0);
-    send(sock, msg, strlen(msg), 0);
-    
-    if (recv(sock, &len, 4, 0) != 4) {
-        close(sock);
-        return -1;
+/* One persistent agent connection for the shell's lifetime */
+static aios_ipc_t g_agent;
+
+/*
+ * Agent requests run on a detached worker thread so the LLM round-trip
+ * never blocks the GTK main loop; all widget updates are posted back
+ * via g_idle_add. One request in flight at a time.
+ */
+
+static gboolean g_agent_busy = FALSE;  /* main-thread only */
+
+struct agent_call {
+    char text[1024];
+    char response[4096];
+    int rc;
+};
+
+struct stream_ctx {
+    char partial[4096];
+    size_t len;
+};
+
+/* Main loop: render streamed text accumulated so far */
+static gboolean show_partial_idle(gpointer data) {
+    char *text = data;
+    gtk_label_set_text(GTK_LABEL(g_response_label), text);
+    g_free(text);
+    return G_SOURCE_REMOVE;
+}
+
+/* Worker thread: append the delta and post the new text to the UI */
+static void on_delta(const char *delta, void *userdata) {
+    struct stream_ctx *ctx = userdata;
+    size_t dlen = strlen(delta);
+
+    if (ctx->len + dlen < sizeof(ctx->partial)) {
+        memcpy(ctx->partial + ctx->len, delta, dlen + 1);
+        ctx->len += dlen;
+        g_idle_add(show_partial_idle, g_strdup(ctx->partial));
     }
-    len = ntohl(len);
-    
-    if (len < response_size) {
-        recv(sock, response, len, 0);
-        response[len] = '\0';
+}
+
+/* Main loop: show the final response and release the pending state */
+static gboolean agent_call_done(gpointer data) {
+    struct agent_call *call = data;
+
+    if (call->rc >= 0) {
+        char *p = strstr(call->response, "\"response\":\"");
+        if (p) {
+            p += 12;
+            char *end = strchr(p, '"');
+            if (end) {
+                *end = '\0';
+                gtk_label_set_text(GTK_LABEL(g_response_label), p);
+            }
+        } else {
+            gtk_label_set_text(GTK_LABEL(g_response_label), call->response);
+        }
+    } else {
+        gtk_label_set_text(GTK_LABEL(g_response_label), "Agent not running");
     }
-    
-    close(sock);
-    return 0;
+
+    gtk_widget_remove_css_class(g_input_entry, "pending");
+    g_agent_busy = FALSE;
+    free(call);
+    return G_SOURCE_REMOVE;
+}
+
+static void *agent_thread(void *data) {
+    struct agent_call *call = data;
+
+    char msg[2048];
+    snprintf(msg, sizeof(msg),
+        "{\"cmd\":\"chat\",\"text\":\"%s\",\"stream\":true}", call->text);
+
+    struct stream_ctx ctx = { .len = 0 };
+    ctx.partial[0] = '\0';
+
+    call->rc = aios_ipc_request_stream(&g_agent, msg, call->response,
+                                       sizeof(call->response), on_delta, &ctx);
+
+    g_idle_add(agent_call_done, call);
+    return NULL;
 }
 
 /* ==================== Clock Update ==================== */
@@ -84,30 +133,22 @@ static gboolean update_clock(gpointer data) {
 static void on_input_activate(GtkEntry *entry, gpointer user_data) {
     GtkEntryBuffer *buffer = gtk_entry_get_buffer(entry);
     const char *text = gtk_entry_buffer_get_text(buffer);
-    
+
     if (!text || !text[0]) return;
-    
+    if (g_agent_busy) return;  /* one request at a time */
+
+    struct agent_call *call = calloc(1, sizeof(*call));
+    if (!call) return;
+    strncpy(call->text, text, sizeof(call->text) - 1);
+
+    g_agent_busy = TRUE;
     gtk_label_set_text(GTK_LABEL(g_response_label), "Thinking...");
-    
-    char response[4096] = {0};
-    if (send_to_agent(text, response, sizeof(response)) == 0) {
-        /* Extract response text */
-        char *p = strstr(response, "\"response\":\"");
-        if (p) {
-            p += 12;
-            char *end = strchr(p, '"');
-            if (end) {
-                *end = '\0';
-                gtk_label_set_text(GTK_LABEL(g_response_label), p);
-            }
-        } else {
-            gtk_label_set_text(GTK_LABEL(g_response_label), response);
-        }
-    } else {
-        gtk_label_set_text(GTK_LABEL(g_response_label), response);
-    }
-    
+    gtk_widget_add_css_class(g_input_entry, "pending");
     gtk_entry_buffer_set_text(buffer, "", 0);
+
+    pthread_t tid;
+    pthread_create(&tid, NULL, agent_thread, call);
+    pthread_detach(tid);
 }
 
 /* ==================== CSS Styling ==================== */
@@ -142,6 +183,10 @@ static void load_css(void) {
         "  border-color: #667eea;"
         "  box-shadow: 0 0 20px rgba(102,126,234,0.3);"
         "}"
+        ".ai-input.pending {"
+        "  border-color: #e0b050;"
+        "  box-shadow: 0 0 20px rgba(224,176,80,0.3);"
+        "}"
         ".response {"
         "  font-size: 20px;"
         "  color: #c0c0e0;"
@@ -266,6 +311,8 @@ static void activate(GtkApplication *app, gpointer user_data) {
 /* ==================== Main ==================== */
 
 int main(int argc, char *argv[]) {
+    aios_ipc_init(&g_agent, AGENT_SOCKET);
+
     GtkApplication *app = gtk_application_new("com.aios.shell", G_APPLICATION_DEFAULT_FLAGS);
     g_signal_connect(app, "activate", G_CALLBACK(activate), NULL);
     